@@ -1 +1 @@
-tclsh c:\Tcl\bin\dtplite.tcl -o winpm.html html winpm.man %*
+tclsh c:\Tcl\bin\dtplite.tcl -o winpm.html html winpm.man %*
@@ -1 +1 @@
-nmake -f makefile.vc clean TCLDIR=c:\tcl
+nmake -f makefile.vc clean TCLDIR=c:\tcl
@@ -1 +1 @@
-nmake -f makefile.vc all TCLDIR=c:\tcl TKDIR=c:\tcl OPTS=symbols
+nmake -f makefile.vc all TCLDIR=c:\tcl TKDIR=c:\tcl OPTS=symbols
@@ -1,801 +1,1959 @@
-/*
- * winpm.c --
- *   Power Management support for Windows Tk applications.
- *
- * Copyright (c) 2007 Konstantin Khomoutov.
- *
- * See the file "license.terms" for information on usage and redistribution
- * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
- *
- * $Id$
- */
-
-#ifdef _MSC_VER
-#define WIN32_LEAN_AND_MEAN
-#endif
-#include <windows.h>
-#include <tchar.h>
-#include <pbt.h> /* MinGW's windows.h doesn't include it for some reason */
-
-#ifndef ENDSESSION_CLOSEAPP
-#define ENDSESSION_CLOSEAPP 0x00000001L
-#endif
-
-#ifndef PBT_APMRESUMEAUTOMATIC
-#define PBT_APMRESUMEAUTOMATIC 0x0012
-#endif
-
-#include <tcl.h>
-#include <tk.h>
-#include <tkPlatDecls.h>
-
-/* Mutex to serialize the process threads through the code
- * which tests the existence of/creates the monitoring window class */
-TCL_DECLARE_MUTEX(global);
-
-typedef struct {
-	Tcl_Interp *interp; /* Interpreter to which this state belongs */
-	HWND hwndMonitor; /* Handle to the monitoring window */
-	Tk_BindingTable bindings;
-	struct {
-		ULONG uMsg;
-		WPARAM wParam;
-		LPARAM lParam;
-	} last;
-} Winpm_InterpData;
-
-static const ClientData BindObject = (ClientData) 0xBAADF00D;
-
-static const char *HandledEvents[] = {
-	"WM_QUERYENDSESSION",
-	"WM_ENDSESSION",
-	"WM_POWERBROADCAST",
-	"PBT_APMPOWERSTATUSCHANGE",
-	"PBT_APMRESUMEAUTOMATIC",
-	"PBT_APMRESUMESUSPEND",
-	"PBT_APMSUSPEND",
-	"PBT_APMBATTERYLOW",
-	"PBT_APMOEMEVENT",
-	"PBT_APMQUERYSUSPEND",
-	"PBT_APMQUERYSUSPENDFAILED",
-	"PBT_APMRESUMECRITICAL",
-	NULL
-};
-
-typedef struct {
-	char token;
-	char value[];
-} Winpm_PercentMap;
-
-#if 0
-static void
-Winpm_ExpandPercents (
-	Tcl_Interp *interp,
-	Winpm_PercentMap *mapPtr,
-	CONST char *before,
-	Tcl_DString *dsPtr
-	)
-{
-	CONST char *string;
-
-	while (1) {
-		break;
-	}
-}
-#endif
-
-/* Code taken from win/tkWinTest.c of Tk
- *----------------------------------------------------------------------
- *
- * AppendSystemError --
- *
- *	This routine formats a Windows system error message and places
- *	it into the interpreter result.  Originally from tclWinReg.c.
- *
- * Results:
- *	None.
- *
- * Side effects:
- *	None.
- *
- *----------------------------------------------------------------------
- */
-
-static void
-AppendSystemError(
-	Tcl_Interp *interp, /* Current interpreter. */
-	DWORD error)        /* Result code from error. */
-{
-	int length;
-	WCHAR *wMsgPtr;
-	char *msg;
-	char id[TCL_INTEGER_SPACE], msgBuf[24 + TCL_INTEGER_SPACE];
-	Tcl_DString ds;
-	Tcl_Obj *resultPtr = Tcl_GetObjResult(interp);
-
-	length = FormatMessageW(FORMAT_MESSAGE_FROM_SYSTEM
-		| FORMAT_MESSAGE_ALLOCATE_BUFFER, NULL, error,
-		MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (WCHAR *) &wMsgPtr,
-		0, NULL);
-	if (length == 0) {
-		char *msgPtr;
-
-		length = FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM
-			| FORMAT_MESSAGE_ALLOCATE_BUFFER, NULL, error,
-			MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (char *) &msgPtr,
-			0, NULL);
-		if (length > 0) {
-			wMsgPtr = (WCHAR *) LocalAlloc(LPTR, (length + 1) * sizeof(WCHAR));
-			MultiByteToWideChar(CP_ACP, 0, msgPtr, length + 1, wMsgPtr,
-				length + 1);
-			LocalFree(msgPtr);
-		}
-	}
-	if (length == 0) {
-		if (error == ERROR_CALL_NOT_IMPLEMENTED) {
-			msg = "function not supported under Win32s";
-		} else {
-			sprintf(msgBuf, "unknown error: %ld", error);
-			msg = msgBuf;
-		}
-	} else {
-		Tcl_Encoding encoding;
-
-		encoding = Tcl_GetEncoding(NULL, "unicode");
-		msg = Tcl_ExternalToUtfDString(encoding, (char *) wMsgPtr, -1, &ds);
-		Tcl_FreeEncoding(encoding);
-		LocalFree(wMsgPtr);
-
-		length = Tcl_DStringLength(&ds);
-
-		/*
-		 * Trim the trailing CR/LF from the system message.
-		 */
-		if (msg[length-1] == '\n') {
-			msg[--length] = 0;
-		}
-		if (msg[length-1] == '\r') {
-			msg[--length] = 0;
-		}
-	}
-
-	sprintf(id, "%ld", error);
-	Tcl_SetErrorCode(interp, "WINDOWS", id, msg, (char *) NULL);
-	Tcl_AppendToObj(resultPtr, msg, length);
-
-	if (length != 0) {
-		Tcl_DStringFree(&ds);
-	}
-}
-
-static int
-Winpm_DispatchEvent (
-	Winpm_InterpData *statePtr,
-	Winpm_PercentMap *mapPtr,
-	CONST char *event
-	)
-{
-	CONST char *script;
-
-	script = Tk_GetBinding(statePtr->interp, statePtr->bindings,
-			BindObject, event);
-	if (script == NULL) {
-		return TCL_OK;
-	} else {
-		int code;
-		Tcl_AllowExceptions(statePtr->interp);
-		code =  Tcl_EvalEx(statePtr->interp, script, -1, TCL_EVAL_GLOBAL);
-		if (code == TCL_ERROR) {
-			Tcl_AddErrorInfo(statePtr->interp, "\n    (command bound to ");
-			Tcl_AddErrorInfo(statePtr->interp, event);
-			Tcl_AddErrorInfo(statePtr->interp, " " PACKAGE_NAME " event)");
-			Tcl_BackgroundError(statePtr->interp);
-		}
-		return code;
-	}
-}
-
-static int
-Winpm_NormalizeEventName (
-	Tcl_Interp *interp,
-	Tcl_Obj *objPtr,
-	CONST char **namePtr
-	)
-{
-	int i;
-
-	if (Tcl_GetIndexFromObj(interp, objPtr,
-			HandledEvents, "event", 0, &i) != TCL_OK) {
-		return TCL_ERROR;
-	} else {
-		*namePtr = HandledEvents[i];
-		return TCL_OK;
-	}
-}
-
-/*
- * winpm bind
- * winpm bind WM_QUERYENDSESSION
- * winpm bind WM_QUERYENDSESSION SCRIPT
- */
-static int
-Winpm_CmdBind (
-	Tcl_Interp *interp,
-	Tk_BindingTable bindings,
-	int objc,
-	Tcl_Obj *const objv[]
-	)
-{
-	switch (objc) {
-		case 2: /* List all currently bound events */
-			Tk_GetAllBindings(interp, bindings, BindObject);
-			return TCL_OK;
-		break;
-
-		case 3: { /* Show binding for an event */
-			CONST char *event, *script;
-
-			if (Winpm_NormalizeEventName(interp, objv[2],
-						&event) != TCL_OK) return TCL_ERROR;
-
-			script = Tk_GetBinding(interp, bindings,
-					BindObject, event);
-			if (script == NULL) {
-				Tcl_ResetResult(interp);
-			} else {
-				Tcl_SetObjResult(interp,
-						Tcl_NewStringObj(script, -1));
-			}
-			return TCL_OK;
-		}
-		break;
-
-		case 4: { /* Create or delete binding */
-			CONST char *event, *script;
-			int len;
-
-			if (Winpm_NormalizeEventName(interp, objv[2],
-					&event) != TCL_OK) {
-				return TCL_ERROR;
-			}
-
-			script = Tcl_GetStringFromObj(objv[3], &len);
-			if (len == 0) {
-				return Tk_DeleteBinding(interp, bindings,
-						BindObject, event);
-			} else {
-				unsigned long mask;
-				int append;
-
-				append = script[0] == '+';
-				if (append) ++script;
-
-				mask = Tk_CreateBinding(interp, bindings,
-						BindObject, event, script, append);
-				if (mask == 0) {
-					return TCL_ERROR;
-				} else {
-					return TCL_OK;
-				}
-			}
-		}
-		break;
-
-		default:
-			Tcl_WrongNumArgs(interp, 2, objv, "?event? ?command?");
-			return TCL_ERROR;
-		break;
-	}
-}
-
-/* winpm info arg ?arg ...? */
-static int
-Winpm_CmdInfo (
-	Tcl_Interp *interp,
-	Winpm_InterpData *statePtr,
-	int objc,
-	Tcl_Obj *const objv[]
-	)
-{
-	static const char *topics[] = { "events", "lastmessage",
-		"session", "power", "id", NULL };
-	typedef enum { INF_EVENTS, INF_LASTMESSAGE,
-		INF_SESSION, INF_POWER, INF_ID } INF_Option;
-	int opt;
-
-	if (objc < 3) {
-		Tcl_WrongNumArgs(interp, 2, objv, "topic ?arg ...?");
-		return TCL_ERROR;
-	}
-
-	if (Tcl_GetIndexFromObj(interp, objv[2], topics, "topic",
-			0, &opt) != TCL_OK) { return TCL_ERROR; }
-
-	switch (opt) {
-		case INF_EVENTS: {
-			int i;
-			CONST char *p;
-			Tcl_Obj *listObj;
-
-			listObj = Tcl_NewListObj(0, NULL);
-			i = 0;
-			p = HandledEvents[i];
-			while (p != NULL) {
-				Tcl_ListObjAppendElement(interp,
-						listObj, Tcl_NewStringObj(p, -1));
-				p = HandledEvents[++i];
-			}
-			Tcl_SetObjResult(interp, listObj);
-			return TCL_OK;
-		}
-		break;
-
-		case INF_LASTMESSAGE: {
-			Tcl_Obj *elems[3];
-
-			elems[0] = Tcl_NewLongObj(statePtr->last.uMsg);
-			elems[1] = Tcl_NewLongObj(statePtr->last.wParam);
-			elems[2] = Tcl_NewLongObj(statePtr->last.lParam);
-
-			Tcl_SetObjResult(interp, Tcl_NewListObj(3, elems));
-			return TCL_OK;
-		}
-		break;
-
-		case INF_SESSION: {
-			typedef struct {
-				LPARAM flag;
-				CONST char *name;
-			} SessFlagMap;
-			static CONST SessFlagMap fmap[] = {
-				{ ENDSESSION_CLOSEAPP, "ENDSESSION_CLOSEAPP" },
-				{ ENDSESSION_LOGOFF,   "ENDSESSION_LOGOFF" }
-			};
-			int i, final;
-			Tcl_Obj *elems[2];
-			Tcl_Obj *flagsObj;
-
-			if (statePtr->last.uMsg != WM_QUERYENDSESSION
-					&& statePtr->last.uMsg != WM_ENDSESSION) {
-				Tcl_SetResult(interp, "Information unavailable", TCL_STATIC);
-				return TCL_ERROR;
-			}
-
-			if (statePtr->last.uMsg == WM_ENDSESSION) {
-				final = statePtr->last.wParam;
-			} else {
-				final = 0;
-			}
-			elems[0] = Tcl_NewBooleanObj(final);
-
-			flagsObj = Tcl_NewListObj(0, NULL);
-			for (i = 0; i < sizeof(fmap)/sizeof(fmap[0]); ++i) {
-				if (statePtr->last.lParam & fmap[i].flag) {
-					if (Tcl_ListObjAppendElement(interp, flagsObj,
-							Tcl_NewStringObj(fmap[i].name,
-								-1)) != TCL_OK) {
-						return TCL_ERROR;
-					}
-				}
-			}
-			elems[1] = flagsObj;
-
-			Tcl_SetObjResult(interp, Tcl_NewListObj(2, elems));
-			return TCL_OK;
-		}
-		break;
-
-		case INF_POWER: {
-			SYSTEM_POWER_STATUS power;
-			CONST char *string;
-			int val;
-			Tcl_Obj *elems[5];
-
-			if (!GetSystemPowerStatus(&power)) {
-				Tcl_ResetResult(statePtr->interp);
-				AppendSystemError(statePtr->interp, GetLastError());
-				return TCL_ERROR;
-			}
-
-			switch (power.ACLineStatus) {
-				case 0:
-					string = "OFFLINE";
-					break;
-				case 1:
-					string = "ONLINE";
-					break;
-				default:
-					string = "UNKNOWN";
-					break;
-			}
-			elems[0] = Tcl_NewStringObj(string, -1);
-
-			switch (power.BatteryFlag) {
-				case 1:
-					string = "HIGH";
-					break;
-				case 2:
-					string = "LOW";
-					break;
-				case 4:
-					string = "CRITICAL";
-					break;
-				case 8:
-					string = "CHARGING";
-					break;
-				case 128:
-					string = "NONE";
-					break;
-				default:
-					string = "UNKNOWN";
-					break;
-			}
-			elems[1] = Tcl_NewStringObj(string, -1);
-
-			if (power.BatteryLifePercent == 255) {
-				val = -1;
-			} else {
-				val = power.BatteryLifePercent;
-			}
-			elems[2] = Tcl_NewIntObj(val);
-
-			elems[3] = Tcl_NewIntObj(power.BatteryLifeTime);
-			elems[4] = Tcl_NewIntObj(power.BatteryFullLifeTime);
-
-			Tcl_SetObjResult(interp, Tcl_NewListObj(5, elems));
-			return TCL_OK;
-		}
-		break;
-
-		case INF_ID: {
-			char buf[sizeof("0xFFFFFFFF")];
-			sprintf(buf, "0x%08X", (unsigned) statePtr->hwndMonitor);
-			Tcl_SetObjResult(interp, Tcl_NewStringObj(buf, -1));
-			return TCL_OK;
-		}
-		break;
-	}
-
-	return TCL_OK;
-}
-
-/* winpm _injectwm uMsg wParam lParam */
-static int
-Winpm_CmdInjectWM (
-	Tcl_Interp *interp,
-	Winpm_InterpData *statePtr,
-	int objc,
-	Tcl_Obj *const objv[]
-	)
-{
-	UINT    uMsg;
-	WPARAM  wParam;
-	LPARAM  lParam;
-	LRESULT res;
-
-	if (objc != 5) {
-		Tcl_WrongNumArgs(interp, 2, objv, "uMsg wParam lParam");
-		return TCL_ERROR;
-	}
-
-	if (Tcl_GetIntFromObj(interp, objv[2], &uMsg) != TCL_OK
-			|| Tcl_GetIntFromObj(interp, objv[3], &wParam) != TCL_OK
-			|| Tcl_GetLongFromObj(interp, objv[4], &lParam) != TCL_OK) {
-		return TCL_ERROR;
-	}
-
-	/* FIXME is it possible for SendMessage to return error? */
-	res = SendMessage(statePtr->hwndMonitor, uMsg, wParam, lParam);
-
-	Tcl_SetObjResult(interp, Tcl_NewLongObj(res));
-	return TCL_OK;
-}
-
-static int
-Winpm_Cmd (
-	ClientData clientData,
-	Tcl_Interp *interp,
-	int objc,
-	Tcl_Obj *const objv[]
-	)
-{
-	static const char *options[] = { "bind", "info", "_injectwm", NULL };
-	typedef enum { WPM_BIND, WPM_INFO, WPM_INJECTWM } WPM_Option;
-	int opt;
-	Winpm_InterpData *statePtr;
-
-	if (objc == 1) {
-		Tcl_WrongNumArgs(interp, 1, objv,
-				"option ?arg ...?");
-		return TCL_ERROR;
-	}
-
-	if (Tcl_GetIndexFromObj(interp, objv[1], options, "option",
-			0, &opt) != TCL_OK) { return TCL_ERROR; }
-
-	statePtr = (Winpm_InterpData *) clientData;
-
-	switch (opt) {
-		case WPM_BIND:
-			return Winpm_CmdBind(interp, statePtr->bindings, objc, objv);
-		break;
-
-		case WPM_INFO:
-			return Winpm_CmdInfo(interp, statePtr, objc, objv);
-		break;
-
-		case WPM_INJECTWM:
-			return Winpm_CmdInjectWM(interp, statePtr, objc, objv);
-		break;
-	}
-
-	return TCL_OK;
-}
-
-static LRESULT
-Winpm_ProcessPowerBcast (
-	Winpm_InterpData *statePtr,
-	WPARAM wParam,
-	LPARAM lParam
-	)
-{
-	CONST char *class;
-
-	lParam = 0; // compiler shut up
-
-	Winpm_DispatchEvent(statePtr, NULL, "WM_POWERBROADCAST");
-
-	switch (wParam) {
-		case PBT_APMPOWERSTATUSCHANGE: {
-			/* TODO when %-expanding will be implemented
-			 * here we should call GetSystemPowerStatus()
-			 * and parse what it returns */
-			class = "PBT_APMPOWERSTATUSCHANGE";
-		}
-		break;
-
-		case PBT_APMRESUMEAUTOMATIC:
-			class = "PBT_APMRESUMEAUTOMATIC";
-		break;
-
-		case PBT_APMRESUMESUSPEND:
-			class = "PBT_APMRESUMESUSPEND";
-		break;
-
-		case PBT_APMSUSPEND:
-			class = "PBT_APMSUSPEND";
-		break;
-
-		/* Events listed below were removed from Vista */
-
-		/* PBT_APMPOWERSTATUSCHANGE should be used instead */
-		case PBT_APMBATTERYLOW:
-			class = "PBT_APMBATTERYLOW";
-		break;
-
-		case PBT_APMOEMEVENT:
-			/* lParam holds OEM event code */
-			class = "PBT_APMOEMEVENT";
-		break;
-
-		case PBT_APMQUERYSUSPEND:
-			/* Special handling: callback script can prevent suspending */
-			if (Winpm_DispatchEvent(statePtr, NULL,
-						"PBT_APMQUERYSUSPEND") == TCL_CONTINUE) {
-				return BROADCAST_QUERY_DENY;
-			} else {
-				return TRUE;
-			}
-		break;
-
-		case PBT_APMQUERYSUSPENDFAILED:
-			class = "PBT_APMQUERYSUSPENDFAILED";
-		break;
-
-		/* PBT_APMRESUMEAUTOMATIC should be used in Vista */
-		case PBT_APMRESUMECRITICAL:
-			class = "PBT_APMRESUMECRITICAL";
-		break;
-
-		default:
-			class = NULL;
-		break;
-	}
-
-	if (class != NULL) {
-		Winpm_DispatchEvent(statePtr, NULL, class);
-	}
-
-	return TRUE;
-}
-
-static Winpm_InterpData*
-GetWindowInterpData (
-	HWND hwnd)
-{
-	return (Winpm_InterpData *)GetWindowLongPtr(hwnd, GWLP_USERDATA);
-}
-
-static void
-SaveLastMessage (
-	Winpm_InterpData *statePtr,
-	UINT uMsg,
-	WPARAM wParam,
-	LPARAM lParam
-	)
-{
-	statePtr->last.uMsg   = uMsg;
-	statePtr->last.wParam = wParam;
-	statePtr->last.lParam = lParam;
-}
-
-static LRESULT CALLBACK
-WndProc(
-	HWND hwnd,
-	UINT uMsg,
-	WPARAM wParam,
-	LPARAM lParam
-	)
-{
-	Winpm_InterpData *statePtr;
-
-	switch (uMsg) {
-		case WM_QUERYENDSESSION:
-			statePtr = GetWindowInterpData(hwnd);
-			SaveLastMessage(statePtr, uMsg, wParam, lParam);
-			return Winpm_DispatchEvent(statePtr,
-					NULL, "WM_QUERYENDSESSION") != TCL_CONTINUE;
-		break;
-
-		case WM_ENDSESSION:
-			statePtr = GetWindowInterpData(hwnd);
-			SaveLastMessage(statePtr, uMsg, wParam, lParam);
-			Winpm_DispatchEvent(statePtr, NULL, "WM_ENDSESSION");
-			return 0;
-		break;
-
-		case WM_POWERBROADCAST:
-			statePtr = GetWindowInterpData(hwnd);
-			SaveLastMessage(statePtr, uMsg, wParam, lParam);
-			return Winpm_ProcessPowerBcast(statePtr, wParam, lParam);
-		break;
-
-		default:
-			return DefWindowProc(hwnd, uMsg, wParam, lParam);
-	}
-}
-
-static int
-CreateMonitorWindow (
-	Tcl_Interp *interp,
-	Winpm_InterpData *statePtr)
-{
-	CONST TCHAR name[]  = _T("TkWinPMMonitorWindow");
-	CONST TCHAR title[] = _T("TkWinPMMonitorWindow");
-
-	HINSTANCE   hinst;
-	WNDCLASSEX  wc;
-	ATOM        rc;
-	HWND        hwnd;
-
-	hinst = Tk_GetHINSTANCE();
-
-	memset(&wc, 0, sizeof(wc));
-	wc.cbSize = sizeof(wc);
-
-	Tcl_MutexLock(&global);
-	if (!GetClassInfoEx(hinst, name, &wc)) {
-		if (GetLastError() != ERROR_CLASS_DOES_NOT_EXIST) {
-			Tcl_MutexUnlock(&global);
-			Tcl_ResetResult(interp);
-			AppendSystemError(interp, GetLastError());
-			return TCL_ERROR;
-		}
-		wc.style         = CS_HREDRAW | CS_VREDRAW;
-		wc.lpfnWndProc   = (WNDPROC) WndProc;
-		wc.cbClsExtra    = 0;
-		wc.cbWndExtra    = 0;
-		wc.hInstance     = hinst;
-		wc.hIcon         = LoadIcon(NULL, IDI_APPLICATION);
-		wc.hIconSm       = LoadIcon(NULL, IDI_APPLICATION);
-		wc.hCursor       = LoadCursor(NULL, IDC_ARROW);
-		wc.hbrBackground = (HBRUSH) COLOR_WINDOW;
-		wc.lpszMenuName  = name;
-		wc.lpszClassName = name;
-
-		rc = RegisterClassEx(&wc);
-		if (rc == 0) {
-			Tcl_MutexUnlock(&global);
-			Tcl_ResetResult(interp);
-			AppendSystemError(interp, GetLastError());
-			return TCL_ERROR;
-		}
-	}
-	Tcl_MutexUnlock(&global);
-
-	if (wc.lpfnWndProc != (WNDPROC) WndProc) {
-		Tcl_SetResult(interp,
-				"Monitoring window class already registered\
-				by a foreign code", TCL_STATIC);
-		return TCL_ERROR;
-	}
-
-	hwnd = CreateWindow(name, title, WS_OVERLAPPEDWINDOW,
-		CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT,
-		NULL, NULL, hinst, NULL);
-	if (hwnd == NULL) {
-		Tcl_ResetResult(interp);
-		AppendSystemError(interp, GetLastError());
-		return TCL_ERROR;
-	}
-
-	SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG)statePtr);
-
-	ShowWindow(hwnd, SW_HIDE);
-	UpdateWindow(hwnd);
-
-	statePtr->hwndMonitor = hwnd;
-
-	return TCL_OK;
-}
-
-static void
-Winpm_Cleanup(ClientData clientData)
-{
-	Winpm_InterpData *statePtr = (Winpm_InterpData *) clientData;
-
-	Tk_DeleteBindingTable(statePtr->bindings);
-	DestroyWindow(statePtr->hwndMonitor);
-
-	ckfree((char *) statePtr);
-}
-
-#ifdef BUILD_winpm
-#undef TCL_STORAGE_CLASS
-#define TCL_STORAGE_CLASS DLLEXPORT
-#endif /* BUILD_winpm */
-
-EXTERN int
-Winpm_Init(Tcl_Interp * interp)
-{
-	Winpm_InterpData *statePtr;
-
-#ifdef USE_TCL_STUBS
-	if (Tcl_InitStubs(interp, "8.1", 0) == NULL) {
-		return TCL_ERROR;
-	}
-#endif
-	if (Tcl_PkgRequire(interp, "Tcl", "8.1", 0) == NULL) {
-		return TCL_ERROR;
-	}
-
-#ifdef USE_TK_STUBS
-	if (Tk_InitStubs(interp, "8.1", 0) == NULL) {
-		return TCL_ERROR;
-	}
-#endif
-	if (Tcl_PkgRequire(interp, "Tk", "8.1", 0) == NULL) {
-		return TCL_ERROR;
-	}
-
-	statePtr = (Winpm_InterpData *) ckalloc(sizeof(Winpm_InterpData));
-	memset(statePtr, 0, sizeof(*statePtr));
-
-	statePtr->interp = interp;
-
-	if (CreateMonitorWindow(interp, statePtr) != TCL_OK) {
-		return TCL_ERROR;
-	}
-
-	statePtr->bindings = Tk_CreateBindingTable(interp);
-
-	Tcl_CreateObjCommand(interp, "winpm", (Tcl_ObjCmdProc *) Winpm_Cmd,
-		(ClientData) statePtr, (Tcl_CmdDeleteProc *) Winpm_Cleanup);
-
-	if (Tcl_PkgProvide(interp, PACKAGE_NAME, PACKAGE_VERSION) != TCL_OK) {
-		return TCL_ERROR;
-	}
-
-	return TCL_OK;
-}
-
+/*
+ * winpm.c --
+ *   Power Management support for Windows Tk applications.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+#include <errno.h>
+#include <limits.h>
+
+/* Mutex to serialize the process threads through the code
+ * which tests the existence of/creates the monitoring window class */
+TCL_DECLARE_MUTEX(global);
+
+static int DecodeStatus (Winpm_InterpData *statePtr, LPARAM lParam,
+		Winpm_Event *eventPtr, Winpm_EventType **detailPtr);
+static int DecodeOem (Winpm_InterpData *statePtr, LPARAM lParam,
+		Winpm_Event *eventPtr, Winpm_EventType **detailPtr);
+
+/*
+ * Events of the messages the monitoring window gets from the system.
+ * The classes of WM_POWERBROADCAST are routed by wParam; some of them
+ * were removed from Vista, PBT_POWERSETTINGCHANGE only appeared there.
+ */
+static Winpm_EventType CoreEvents[] = {
+	{ "WM_QUERYENDSESSION", WINPM_QUERYENDSESSION, 0, 0,
+		WINPM_EVENT_QUERY },
+	{ "WM_ENDSESSION", WINPM_ENDSESSION },
+	{ "WM_POWERBROADCAST" }, /* Any class */
+	{ "PBT_APMPOWERSTATUSCHANGE", WINPM_POWERSTATUSCHANGE,
+		WM_POWERBROADCAST, PBT_APMPOWERSTATUSCHANGE, 0, DecodeStatus },
+	{ "PBT_APMRESUMEAUTOMATIC", WINPM_RESUMEAUTOMATIC,
+		WM_POWERBROADCAST, PBT_APMRESUMEAUTOMATIC, WINPM_EVENT_RESUME },
+	{ "PBT_APMRESUMESUSPEND", WINPM_RESUMESUSPEND,
+		WM_POWERBROADCAST, PBT_APMRESUMESUSPEND, WINPM_EVENT_RESUME },
+	{ "PBT_APMSUSPEND", WINPM_SUSPEND,
+		WM_POWERBROADCAST, PBT_APMSUSPEND },
+	{ "PBT_APMBATTERYLOW", WINPM_BATTERYLOW,
+		WM_POWERBROADCAST, PBT_APMBATTERYLOW },
+	{ "PBT_APMOEMEVENT", WINPM_OEMEVENT,
+		WM_POWERBROADCAST, PBT_APMOEMEVENT, 0, DecodeOem },
+	{ "PBT_APMQUERYSUSPEND", WINPM_QUERYSUSPEND,
+		WM_POWERBROADCAST, PBT_APMQUERYSUSPEND, WINPM_EVENT_QUERY },
+	{ "PBT_APMQUERYSUSPENDFAILED", WINPM_QUERYSUSPENDFAILED,
+		WM_POWERBROADCAST, PBT_APMQUERYSUSPENDFAILED },
+	{ "PBT_APMRESUMECRITICAL", WINPM_RESUMECRITICAL,
+		WM_POWERBROADCAST, PBT_APMRESUMECRITICAL, WINPM_EVENT_RESUME },
+	{ "PBT_POWERSETTINGCHANGE", WINPM_PROFILECHANGE,
+		WM_POWERBROADCAST, PBT_POWERSETTINGCHANGE, 0, Winpm_DecodeSetting },
+	{ WINPM_TIMECHANGE_EVENT, WINPM_TIMECHANGE },
+	{ NULL }
+};
+typedef enum { EV_QUERYENDSESSION, EV_ENDSESSION, EV_POWERBROADCAST,
+	EV_POWERSTATUSCHANGE, EV_RESUMEAUTOMATIC, EV_RESUMESUSPEND,
+	EV_SUSPEND, EV_BATTERYLOW, EV_OEMEVENT, EV_QUERYSUSPEND,
+	EV_QUERYSUSPENDFAILED, EV_RESUMECRITICAL, EV_POWERSETTINGCHANGE,
+	EV_TIMECHANGE } EV_Core;
+
+/*
+ * Returns the copy of the script with each %-token found in the map
+ * replaced with its value, quoted as a list element, and each "%%"
+ * replaced with a single "%". Unknown %-tokens are left as is.
+ * Modelled after ExpandPercents() from generic/tkBind.c of Tk.
+ */
+static Tcl_Obj *
+Winpm_ExpandPercents (
+	CONST Winpm_PercentMap *mapPtr,
+	Tcl_Obj *scriptObj
+	)
+{
+	CONST Winpm_PercentMap *entryPtr;
+	CONST char *string, *p;
+	Tcl_DString ds;
+	Tcl_Obj *resultObj;
+	int flags, len, needed;
+
+	Tcl_DStringInit(&ds);
+	string = Tcl_GetString(scriptObj);
+
+	while (1) {
+		p = strchr(string, '%');
+		if (p == NULL) {
+			Tcl_DStringAppend(&ds, string, -1);
+			break;
+		}
+		Tcl_DStringAppend(&ds, string, p - string);
+
+		if (p[1] == '%') {
+			Tcl_DStringAppend(&ds, "%", 1);
+			string = p + 2;
+			continue;
+		}
+
+		for (entryPtr = mapPtr; entryPtr->token != '\0'; ++entryPtr) {
+			if (entryPtr->token == p[1]) break;
+		}
+		if (entryPtr->token == '\0') {
+			Tcl_DStringAppend(&ds, "%", 1);
+			string = p + 1;
+			continue;
+		}
+
+		needed = Tcl_ScanElement(entryPtr->value, &flags);
+		len = Tcl_DStringLength(&ds);
+		Tcl_DStringSetLength(&ds, len + needed);
+		needed = Tcl_ConvertElement(entryPtr->value,
+				Tcl_DStringValue(&ds) + len, flags | TCL_DONT_USE_BRACES);
+		Tcl_DStringSetLength(&ds, len + needed);
+
+		string = p + 2;
+	}
+
+	resultObj = Tcl_NewStringObj(Tcl_DStringValue(&ds),
+			Tcl_DStringLength(&ds));
+	Tcl_DStringFree(&ds);
+
+	return resultObj;
+}
+
+/* Code taken from win/tkWinTest.c of Tk
+ *----------------------------------------------------------------------
+ *
+ * Winpm_AppendSystemError --
+ *
+ *	This routine formats a Windows system error message and places
+ *	it into the interpreter result.  Originally from tclWinReg.c.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+Winpm_AppendSystemError(
+	Tcl_Interp *interp, /* Current interpreter. */
+	DWORD error)        /* Result code from error. */
+{
+	int length;
+	WCHAR *wMsgPtr;
+	char *msg;
+	char id[TCL_INTEGER_SPACE], msgBuf[24 + TCL_INTEGER_SPACE];
+	Tcl_DString ds;
+	Tcl_Obj *resultPtr = Tcl_GetObjResult(interp);
+
+	length = FormatMessageW(FORMAT_MESSAGE_FROM_SYSTEM
+		| FORMAT_MESSAGE_ALLOCATE_BUFFER, NULL, error,
+		MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (WCHAR *) &wMsgPtr,
+		0, NULL);
+	if (length == 0) {
+		char *msgPtr;
+
+		length = FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM
+			| FORMAT_MESSAGE_ALLOCATE_BUFFER, NULL, error,
+			MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (char *) &msgPtr,
+			0, NULL);
+		if (length > 0) {
+			wMsgPtr = (WCHAR *) LocalAlloc(LPTR, (length + 1) * sizeof(WCHAR));
+			MultiByteToWideChar(CP_ACP, 0, msgPtr, length + 1, wMsgPtr,
+				length + 1);
+			LocalFree(msgPtr);
+		}
+	}
+	if (length == 0) {
+		if (error == ERROR_CALL_NOT_IMPLEMENTED) {
+			msg = "function not supported under Win32s";
+		} else {
+			sprintf(msgBuf, "unknown error: %ld", error);
+			msg = msgBuf;
+		}
+	} else {
+		Tcl_Encoding encoding;
+
+		encoding = Tcl_GetEncoding(NULL, "unicode");
+		msg = Tcl_ExternalToUtfDString(encoding, (char *) wMsgPtr, -1, &ds);
+		Tcl_FreeEncoding(encoding);
+		LocalFree(wMsgPtr);
+
+		length = Tcl_DStringLength(&ds);
+
+		/*
+		 * Trim the trailing CR/LF from the system message.
+		 */
+		if (msg[length-1] == '\n') {
+			msg[--length] = 0;
+		}
+		if (msg[length-1] == '\r') {
+			msg[--length] = 0;
+		}
+	}
+
+	sprintf(id, "%ld", error);
+	Tcl_SetErrorCode(interp, "WINDOWS", id, msg, (char *) NULL);
+	Tcl_AppendToObj(resultPtr, msg, length);
+
+	if (length != 0) {
+		Tcl_DStringFree(&ds);
+	}
+}
+
+/*
+ * Evaluates a script in the global scope making sure it won't run past
+ * the given absolute deadline. The time limit of the interpreter is
+ * restored afterwards so that our deadline doesn't leak into the code
+ * which may have set its own limit; the stricter of the two is used
+ * while the script runs. *expiredPtr is set to 1 if it was our deadline
+ * which has cancelled the script.
+ */
+int
+Winpm_EvalLimited (
+	Tcl_Interp *interp,
+	Tcl_Obj *scriptObj,
+	CONST Tcl_Time *deadlinePtr,
+	int *expiredPtr
+	)
+{
+	Tcl_Time saved, limit;
+	int hadLimit, ours, code;
+
+	hadLimit = Tcl_LimitTypeEnabled(interp, TCL_LIMIT_TIME);
+	limit = *deadlinePtr;
+	ours = 1;
+	if (hadLimit) {
+		Tcl_LimitGetTime(interp, &saved);
+		if (saved.sec < limit.sec || (saved.sec == limit.sec
+				&& saved.usec <= limit.usec)) {
+			limit = saved;
+			ours = 0;
+		}
+	}
+
+	Tcl_LimitSetTime(interp, &limit);
+	Tcl_LimitTypeSet(interp, TCL_LIMIT_TIME);
+
+	Tcl_IncrRefCount(scriptObj);
+	Tcl_AllowExceptions(interp);
+	code = Tcl_EvalObjEx(interp, scriptObj, TCL_EVAL_GLOBAL);
+	Tcl_DecrRefCount(scriptObj);
+
+	*expiredPtr = ours && Tcl_LimitExceeded(interp);
+
+	if (hadLimit) {
+		Tcl_LimitSetTime(interp, &saved);
+	} else {
+		Tcl_LimitTypeReset(interp, TCL_LIMIT_TIME);
+	}
+
+	return code;
+}
+
+/*
+ * Returns the state of the package in the interpreter for use by the
+ * public C interface; leaves an error message in the interpreter
+ * and returns NULL if the package is not loaded into it.
+ */
+Winpm_InterpData *
+Winpm_GetInterpData (
+	Tcl_Interp *interp
+	)
+{
+	Winpm_InterpData *statePtr;
+
+	statePtr = (Winpm_InterpData *) Tcl_GetAssocData(interp,
+			WINPM_ASSOC_KEY, NULL);
+	if (statePtr == NULL) {
+		Tcl_SetResult(interp, "package " PACKAGE_NAME
+				" is not loaded into this interpreter", TCL_STATIC);
+	}
+	return statePtr;
+}
+
+static void
+FreeBinding (
+	char *blockPtr
+	)
+{
+	Winpm_Binding *bindPtr = (Winpm_Binding *) blockPtr;
+
+	Tcl_DecrRefCount(bindPtr->scriptObj);
+	ckfree((char *) bindPtr);
+}
+
+Winpm_Binding *
+Winpm_FindBinding (
+	Winpm_InterpData *statePtr,
+	CONST Winpm_EventType *typePtr
+	)
+{
+	return statePtr->bindings[typePtr->id];
+}
+
+/* Pending run of a staggered binding */
+struct Winpm_Staggered {
+	Winpm_InterpData *statePtr;
+	Winpm_Binding *bindPtr; /* Preserved until the run */
+	CONST Winpm_EventType *typePtr;
+	Tcl_Obj *scriptObj; /* With the %-tokens substituted */
+	Tcl_TimerToken token;
+	Winpm_Staggered *nextPtr;
+};
+
+/*
+ * Evaluates the script of the binding under its budget,
+ * accounts the run and reports errors. The script of an
+ * asynchronous binding is launched instead.
+ */
+static int
+Winpm_RunBinding (
+	Winpm_InterpData *statePtr,
+	Winpm_Binding *bindPtr,
+	Tcl_Obj *scriptObj,
+	CONST Winpm_EventType *typePtr
+	)
+{
+	Tcl_Interp *interp = statePtr->interp;
+	CONST char *event = typePtr->name;
+	int code, expired;
+
+	if (bindPtr->failures.disabled) {
+		return TCL_OK;
+	}
+
+	if (bindPtr->async) {
+		return Winpm_RunAsync(statePtr, bindPtr, scriptObj, event,
+				typePtr->flags & WINPM_EVENT_QUERY);
+	}
+
+	++bindPtr->stats.calls;
+
+	if (bindPtr->budget > 0) {
+		Tcl_Time deadline;
+
+		Tcl_GetTime(&deadline);
+		deadline.sec  += (long) (bindPtr->budget / 1000000);
+		deadline.usec += (long) (bindPtr->budget % 1000000);
+		if (deadline.usec >= 1000000) {
+			deadline.usec -= 1000000;
+			++deadline.sec;
+		}
+		code = Winpm_EvalLimited(interp, scriptObj, &deadline, &expired);
+	} else {
+		Tcl_AllowExceptions(interp);
+		code = Tcl_EvalObjEx(interp, scriptObj, TCL_EVAL_GLOBAL);
+		expired = 0;
+	}
+
+	if (expired) {
+		/* Cancelled handlers are only accounted, not reported */
+		++bindPtr->stats.overruns;
+		Tcl_ResetResult(interp);
+	} else if (code == TCL_ERROR) {
+		++bindPtr->stats.errors;
+		Tcl_AddErrorInfo(interp, "\n    (command bound to ");
+		Tcl_AddErrorInfo(interp, event);
+		Tcl_AddErrorInfo(interp, " " PACKAGE_NAME " event)");
+		Winpm_ReportError(statePtr, bindPtr, event);
+	} else {
+		bindPtr->failures.consecutive = 0;
+	}
+
+	return code;
+}
+
+static void
+Winpm_FreeStaggered (
+	Winpm_Staggered *runPtr
+	)
+{
+	Winpm_Staggered **linkPtr;
+
+	for (linkPtr = &runPtr->statePtr->staggered; *linkPtr != runPtr;
+			linkPtr = &(*linkPtr)->nextPtr) {}
+	*linkPtr = runPtr->nextPtr;
+
+	Tcl_DecrRefCount(runPtr->scriptObj);
+	Tcl_Release((ClientData) runPtr->bindPtr);
+	ckfree((char *) runPtr);
+}
+
+static void
+Winpm_RunStaggered (
+	ClientData clientData
+	)
+{
+	Winpm_Staggered *runPtr = (Winpm_Staggered *) clientData;
+	Winpm_InterpData *statePtr = runPtr->statePtr;
+
+	/* Runs of a binding which has been replaced or removed are dropped */
+	if (Winpm_FindBinding(statePtr, runPtr->typePtr) == runPtr->bindPtr) {
+		Tcl_Preserve((ClientData) statePtr->interp);
+		Winpm_RunBinding(statePtr, runPtr->bindPtr, runPtr->scriptObj,
+				runPtr->typePtr);
+		Tcl_Release((ClientData) statePtr->interp);
+	}
+
+	Winpm_FreeStaggered(runPtr);
+}
+
+/*
+ * Picks the delay for the staggered run of the binding, in
+ * milliseconds: either random or derived from the name of the host
+ * (and the event), so that it's different for each machine but stays
+ * the same across resumes.
+ */
+static int
+Winpm_StaggerDelay (
+	Winpm_Binding *bindPtr,
+	CONST char *event
+	)
+{
+	/* -stagger is at most INT_MAX ms, so the range can't overflow */
+	unsigned long range = (unsigned long) (bindPtr->stagger / 1000) + 1;
+	unsigned long hash;
+	char host[64];
+	DWORD len;
+	CONST char *p;
+
+	if (bindPtr->spread == WINPM_SPREAD_RANDOM) {
+		hash = ((unsigned long) rand() << 15 | rand()) ^ GetTickCount();
+		return (int) (hash % range);
+	}
+
+	/* FNV-1a */
+	hash = 2166136261UL;
+	len = sizeof(host);
+	if (GetComputerNameA(host, &len)) {
+		for (p = host; *p != '\0'; ++p) {
+			hash = (hash ^ (unsigned char) *p) * 16777619UL;
+		}
+	}
+	for (p = event; *p != '\0'; ++p) {
+		hash = (hash ^ (unsigned char) *p) * 16777619UL;
+	}
+	return (int) (hash % range);
+}
+
+/* Arranges for the script of the binding to be run after a delay */
+static void
+Winpm_StaggerBinding (
+	Winpm_InterpData *statePtr,
+	Winpm_Binding *bindPtr,
+	CONST Winpm_PercentMap *mapPtr,
+	CONST Winpm_EventType *typePtr
+	)
+{
+	Winpm_Staggered *runPtr;
+	Winpm_PercentMap map[16];
+	char delay[TCL_INTEGER_SPACE];
+	int i, ms;
+
+	ms = Winpm_StaggerDelay(bindPtr, typePtr->name);
+
+	/* The delay is substituted for %d along with the other tokens */
+	i = 0;
+	if (mapPtr != NULL) {
+		for (; mapPtr[i].token != '\0' && i < 14; ++i) {
+			map[i] = mapPtr[i];
+		}
+	}
+	sprintf(delay, "%d", ms);
+	map[i].token = 'd';
+	map[i].value = delay;
+	map[i+1].token = '\0';
+
+	runPtr = (Winpm_Staggered *) ckalloc(sizeof(Winpm_Staggered));
+	runPtr->statePtr = statePtr;
+	runPtr->bindPtr = bindPtr;
+	runPtr->typePtr = typePtr;
+	runPtr->scriptObj = Winpm_ExpandPercents(map, bindPtr->scriptObj);
+	Tcl_IncrRefCount(runPtr->scriptObj);
+	runPtr->nextPtr = statePtr->staggered;
+	statePtr->staggered = runPtr;
+
+	Tcl_Preserve((ClientData) bindPtr);
+	runPtr->token = Tcl_CreateTimerHandler(ms, Winpm_RunStaggered,
+			(ClientData) runPtr);
+}
+
+/*
+ * Runs the script bound to the event, if any. The binding is found by
+ * the id of the type of the event. mapPtr, if not NULL,
+ * provides values for the %-tokens in the script. For status change
+ * notifications, changed holds the WINPM_POWER_* bits of the fields
+ * which have changed and the script bound with -on is skipped if none
+ * of its fields is among them; otherwise changed is -1. Scripts bound
+ * to resume events with -stagger are only scheduled, so TCL_OK is
+ * returned for them.
+ */
+int
+Winpm_DispatchEvent (
+	Winpm_InterpData *statePtr,
+	CONST Winpm_PercentMap *mapPtr,
+	int changed,
+	CONST Winpm_EventType *typePtr
+	)
+{
+	Winpm_Binding *bindPtr;
+	Tcl_Obj *scriptObj;
+	int code;
+
+	bindPtr = statePtr->bindings[typePtr->id];
+	if (bindPtr == NULL || bindPtr->failures.disabled) {
+		return TCL_OK;
+	}
+	if (bindPtr->fields != 0 && changed != -1
+			&& (bindPtr->fields & changed) == 0) {
+		return TCL_OK;
+	}
+
+	if (bindPtr->stagger > 0 && (typePtr->flags & WINPM_EVENT_RESUME)) {
+		Winpm_StaggerBinding(statePtr, bindPtr, mapPtr, typePtr);
+		return TCL_OK;
+	}
+
+	/* The script is free to rebind or unbind the event */
+	Tcl_Preserve((ClientData) bindPtr);
+	if (mapPtr != NULL) {
+		scriptObj = Winpm_ExpandPercents(mapPtr, bindPtr->scriptObj);
+	} else {
+		scriptObj = bindPtr->scriptObj;
+	}
+	Tcl_IncrRefCount(scriptObj);
+
+	code = Winpm_RunBinding(statePtr, bindPtr, scriptObj, typePtr);
+
+	Tcl_DecrRefCount(scriptObj);
+	Tcl_Release((ClientData) bindPtr);
+
+	return code;
+}
+
+/*
+ * Runs the script bound to WM_POWERBROADCAST and then the one bound
+ * to the class of the message. Returns the result of the latter.
+ * Batched channels are flushed before the system suspends.
+ */
+int
+Winpm_DispatchPowerBcast (
+	Winpm_InterpData *statePtr,
+	CONST Winpm_PercentMap *mapPtr,
+	int changed,
+	CONST Winpm_EventType *classPtr
+	)
+{
+	int code;
+
+	Winpm_DispatchEvent(statePtr, mapPtr, changed,
+			&CoreEvents[EV_POWERBROADCAST]);
+	if (classPtr == NULL) {
+		return TCL_OK;
+	}
+	code = Winpm_DispatchEvent(statePtr, mapPtr, changed, classPtr);
+
+	/* Whatever the scripts have written should reach the disk first */
+	if (classPtr == &CoreEvents[EV_SUSPEND]) {
+		Winpm_FlushBatches(statePtr);
+	}
+	return code;
+}
+
+/*
+ * Delivers the event to the subscribers and then runs the script bound
+ * to it. Used for the events which don't come in classes.
+ * Returns TCL_CONTINUE if either asked to deny the request.
+ */
+int
+Winpm_FireEvent (
+	Winpm_InterpData *statePtr,
+	CONST Winpm_Event *eventPtr,
+	CONST Winpm_PercentMap *mapPtr,
+	CONST Winpm_EventType *typePtr
+	)
+{
+	int denied;
+
+	denied = Winpm_NotifySubscribers(statePtr, eventPtr) == TCL_CONTINUE;
+	if (Winpm_DispatchEvent(statePtr, mapPtr, -1, typePtr) == TCL_CONTINUE) {
+		denied = 1;
+	}
+
+	return denied ? TCL_CONTINUE : TCL_OK;
+}
+
+/*
+ * Parses a time interval like "50ms", "200us", "2s" or just "50"
+ * (which means milliseconds) into the number of microseconds.
+ * The interval must fit the int milliseconds timers take.
+ */
+int
+Winpm_GetIntervalFromObj (
+	Tcl_Interp *interp,
+	Tcl_Obj *objPtr,
+	Tcl_WideInt *usecPtr
+	)
+{
+	static const struct {
+		CONST char *suffix;
+		Tcl_WideInt scale;
+	} units[] = {
+		{ "us", 1 }, { "ms", 1000 }, { "s", 1000000 }, { "", 1000 }
+	};
+	CONST char *string;
+	char *end;
+	long value;
+	Tcl_WideInt usec;
+	int i;
+
+	string = Tcl_GetString(objPtr);
+	errno = 0;
+	value = strtol(string, &end, 10);
+	if (end != string && value >= 0) {
+		for (i = 0; i < sizeof(units)/sizeof(units[0]); ++i) {
+			if (strcmp(end, units[i].suffix) != 0) continue;
+			usec = value * units[i].scale;
+			if (errno == ERANGE || usec / 1000 > INT_MAX) {
+				if (interp != NULL) {
+					Tcl_AppendResult(interp, "bad interval \"", string,
+							"\": must be at most 2147483647ms", NULL);
+				}
+				return TCL_ERROR;
+			}
+			*usecPtr = usec;
+			return TCL_OK;
+		}
+	}
+
+	if (interp != NULL) {
+		Tcl_AppendResult(interp, "bad interval \"", string,
+				"\": must be a non-negative integer optionally"
+				" followed by us, ms or s", NULL);
+	}
+	return TCL_ERROR;
+}
+
+Tcl_Obj *
+Winpm_NewIntervalObj (
+	Tcl_WideInt usec
+	)
+{
+	char buf[TCL_INTEGER_SPACE + 2];
+
+	if (usec % 1000 == 0) {
+		sprintf(buf, "%ldms", (long) (usec / 1000));
+	} else {
+		sprintf(buf, "%ldus", (long) usec);
+	}
+	return Tcl_NewStringObj(buf, -1);
+}
+
+static const char *BindOptions[] = { "-async", "-budget", "-on",
+	"-spread", "-stagger", "-threshold", "-window", NULL };
+typedef enum { BOPT_ASYNC, BOPT_BUDGET, BOPT_ON, BOPT_SPREAD,
+	BOPT_STAGGER, BOPT_THRESHOLD, BOPT_WINDOW } BOPT_Option;
+
+static const char *SpreadNames[] = { "random", "host", NULL };
+
+/*
+ * Applies binding options from objv (which must have even objc)
+ * to the binding record. Nothing is changed on error.
+ */
+static int
+Winpm_ConfigureBinding (
+	Tcl_Interp *interp,
+	Winpm_Binding *bindPtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Winpm_Binding new;
+	int i, opt;
+
+	new = *bindPtr;
+
+	for (i = 0; i < objc; i += 2) {
+		if (Tcl_GetIndexFromObj(interp, objv[i], BindOptions, "option",
+				0, &opt) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		switch (opt) {
+			case BOPT_ASYNC:
+				if (Tcl_GetBooleanFromObj(interp, objv[i+1],
+						&new.async) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				if (new.async && !Winpm_HasCoroutines(interp)) {
+					Tcl_SetResult(interp, "-async needs coroutines"
+							" (Tcl 8.6 or later)", TCL_STATIC);
+					return TCL_ERROR;
+				}
+			break;
+
+			case BOPT_BUDGET:
+				if (Winpm_GetIntervalFromObj(interp, objv[i+1],
+						&new.budget) != TCL_OK) {
+					return TCL_ERROR;
+				}
+			break;
+
+			case BOPT_ON:
+				if (Winpm_GetPowerFieldsFromObj(interp, objv[i+1],
+						&new.fields) != TCL_OK) {
+					return TCL_ERROR;
+				}
+			break;
+
+			case BOPT_SPREAD:
+				if (Tcl_GetIndexFromObj(interp, objv[i+1], SpreadNames,
+						"spread", 0, &new.spread) != TCL_OK) {
+					return TCL_ERROR;
+				}
+			break;
+
+			case BOPT_STAGGER:
+				if (Winpm_GetIntervalFromObj(interp, objv[i+1],
+						&new.stagger) != TCL_OK) {
+					return TCL_ERROR;
+				}
+			break;
+
+			case BOPT_THRESHOLD:
+				if (Tcl_GetIntFromObj(interp, objv[i+1],
+						&new.threshold) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				if (new.threshold < 1 || new.threshold > 100) {
+					Tcl_AppendResult(interp, "bad value for -threshold: \"",
+							Tcl_GetString(objv[i+1]), "\"", NULL);
+					return TCL_ERROR;
+				}
+			break;
+
+			case BOPT_WINDOW:
+				if (Winpm_GetIntervalFromObj(interp, objv[i+1],
+						&new.window) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				if (new.window < 1000) {
+					Tcl_AppendResult(interp, "bad value for -window: \"",
+							Tcl_GetString(objv[i+1]), "\"", NULL);
+					return TCL_ERROR;
+				}
+			break;
+		}
+	}
+
+	*bindPtr = new;
+	return TCL_OK;
+}
+
+/*
+ * winpm bind
+ * winpm bind WM_QUERYENDSESSION
+ * winpm bind WM_QUERYENDSESSION ?-option value ...? SCRIPT
+ */
+static int
+Winpm_CmdBind (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Winpm_EventType *typePtr;
+	Winpm_Binding *bindPtr, new;
+	CONST char *event, *script;
+	int len, append;
+
+	if (objc == 2) { /* List all currently bound events */
+		Tcl_Obj *listObj;
+		int id;
+
+		listObj = Tcl_NewListObj(0, NULL);
+		for (id = 0; id < Winpm_CountEvents(); ++id) {
+			if (statePtr->bindings[id] != NULL) {
+				Tcl_ListObjAppendElement(interp, listObj, Tcl_NewStringObj(
+						Winpm_GetEventType(id)->name, -1));
+			}
+		}
+		Tcl_SetObjResult(interp, listObj);
+		return TCL_OK;
+	}
+
+	if (objc % 2 != 0 && objc != 3) {
+		Tcl_WrongNumArgs(interp, 2, objv,
+				"?event? ?-option value ...? ?command?");
+		return TCL_ERROR;
+	}
+
+	if (Winpm_GetEventTypeFromObj(interp, objv[2], &typePtr) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	event = typePtr->name;
+
+	if (objc == 3) { /* Show binding for an event */
+		bindPtr = Winpm_FindBinding(statePtr, typePtr);
+		if (bindPtr == NULL) {
+			Tcl_ResetResult(interp);
+		} else {
+			Tcl_SetObjResult(interp, bindPtr->scriptObj);
+		}
+		return TCL_OK;
+	}
+
+	/* Create or delete binding */
+
+	script = Tcl_GetStringFromObj(objv[objc-1], &len);
+	if (len == 0) {
+		bindPtr = Winpm_FindBinding(statePtr, typePtr);
+		if (bindPtr != NULL) {
+			Winpm_FlushErrors(statePtr, bindPtr, event);
+			statePtr->bindings[typePtr->id] = NULL;
+			Tcl_EventuallyFree((ClientData) bindPtr, FreeBinding);
+			Winpm_ReleaseMonitor(statePtr);
+		}
+		if (typePtr->bindProc != NULL) {
+			typePtr->bindProc(statePtr);
+		}
+		return TCL_OK;
+	}
+
+	append = script[0] == '+';
+	if (append) {
+		++script;
+		--len;
+	}
+
+	bindPtr = Winpm_FindBinding(statePtr, typePtr);
+
+	memset(&new, 0, sizeof(new));
+	new.threshold = WINPM_MEMORY_THRESHOLD;
+	new.window = WINPM_MEMORY_WINDOW;
+	if (bindPtr != NULL) {
+		new.stats = bindPtr->stats;
+		if (append) {
+			new = *bindPtr;
+		} else {
+			/* A new script starts with a clean record */
+			Winpm_FlushErrors(statePtr, bindPtr, event);
+		}
+		new.failures.consecutive = 0;
+		new.failures.disabled = 0;
+	}
+	if (Winpm_ConfigureBinding(interp, &new, objc - 4, objv + 3) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	if (bindPtr == NULL && Winpm_HoldMonitor(statePtr) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	if (bindPtr != NULL && append) {
+		new.scriptObj = Tcl_DuplicateObj(bindPtr->scriptObj);
+		Tcl_AppendToObj(new.scriptObj, "\n", 1);
+		Tcl_AppendToObj(new.scriptObj, script, len);
+	} else {
+		new.scriptObj = Tcl_NewStringObj(script, len);
+	}
+	Tcl_IncrRefCount(new.scriptObj);
+
+	if (bindPtr != NULL) {
+		/* The old record may be in use by the running script */
+		Tcl_EventuallyFree((ClientData) bindPtr, FreeBinding);
+	}
+
+	bindPtr = (Winpm_Binding *) ckalloc(sizeof(Winpm_Binding));
+	*bindPtr = new;
+	statePtr->bindings[typePtr->id] = bindPtr;
+
+	if (typePtr->bindProc != NULL) {
+		typePtr->bindProc(statePtr);
+	}
+
+	return TCL_OK;
+}
+
+static Tcl_Obj *
+Winpm_NewStatsObj (
+	Winpm_Binding *bindPtr
+	)
+{
+	Tcl_Obj *elems[10];
+
+	elems[0] = Tcl_NewStringObj("calls", -1);
+	elems[1] = Tcl_NewLongObj(bindPtr->stats.calls);
+	elems[2] = Tcl_NewStringObj("errors", -1);
+	elems[3] = Tcl_NewLongObj(bindPtr->stats.errors);
+	elems[4] = Tcl_NewStringObj("overruns", -1);
+	elems[5] = Tcl_NewLongObj(bindPtr->stats.overruns);
+	elems[6] = Tcl_NewStringObj("suppressed", -1);
+	elems[7] = Tcl_NewLongObj(bindPtr->stats.suppressed);
+	elems[8] = Tcl_NewStringObj("disabled", -1);
+	elems[9] = Tcl_NewBooleanObj(bindPtr->failures.disabled);
+
+	return Tcl_NewListObj(10, elems);
+}
+
+/* winpm info arg ?arg ...? */
+static int
+Winpm_CmdInfo (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *topics[] = { "events", "lastmessage",
+		"session", "power", "id", "binding", "stats", "queue",
+		"profile", "idle", "broker", "event", "async", NULL };
+	typedef enum { INF_EVENTS, INF_LASTMESSAGE, INF_SESSION, INF_POWER,
+		INF_ID, INF_BINDING, INF_STATS, INF_QUEUE,
+		INF_PROFILE, INF_IDLE, INF_BROKER, INF_EVENT,
+		INF_ASYNC } INF_Option;
+	int opt;
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "topic ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], topics, "topic",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	switch (opt) {
+		case INF_EVENTS:
+			Tcl_SetObjResult(interp, Winpm_NewEventNamesObj());
+			return TCL_OK;
+		break;
+
+		case INF_EVENT: {
+			Winpm_EventType *typePtr;
+
+			if (objc != 4) {
+				Tcl_WrongNumArgs(interp, 3, objv, "event");
+				return TCL_ERROR;
+			}
+			if (Winpm_GetEventTypeFromObj(interp, objv[3],
+					&typePtr) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult(interp, Winpm_NewEventTypeObj(typePtr));
+			return TCL_OK;
+		}
+		break;
+
+		case INF_LASTMESSAGE: {
+			Tcl_Obj *elems[3];
+
+			elems[0] = Tcl_NewLongObj(statePtr->last.uMsg);
+			elems[1] = Tcl_NewLongObj(statePtr->last.wParam);
+			elems[2] = Tcl_NewLongObj(statePtr->last.lParam);
+
+			Tcl_SetObjResult(interp, Tcl_NewListObj(3, elems));
+			return TCL_OK;
+		}
+		break;
+
+		case INF_SESSION: {
+			typedef struct {
+				LPARAM flag;
+				CONST char *name;
+			} SessFlagMap;
+			static CONST SessFlagMap fmap[] = {
+				{ ENDSESSION_CLOSEAPP, "ENDSESSION_CLOSEAPP" },
+				{ ENDSESSION_LOGOFF,   "ENDSESSION_LOGOFF" }
+			};
+			int i, final;
+			Tcl_Obj *elems[2];
+			Tcl_Obj *flagsObj;
+
+			if (statePtr->last.uMsg != WM_QUERYENDSESSION
+					&& statePtr->last.uMsg != WM_ENDSESSION) {
+				Tcl_SetResult(interp, "Information unavailable", TCL_STATIC);
+				return TCL_ERROR;
+			}
+
+			if (statePtr->last.uMsg == WM_ENDSESSION) {
+				final = statePtr->last.wParam;
+			} else {
+				final = 0;
+			}
+			elems[0] = Tcl_NewBooleanObj(final);
+
+			flagsObj = Tcl_NewListObj(0, NULL);
+			for (i = 0; i < sizeof(fmap)/sizeof(fmap[0]); ++i) {
+				if (statePtr->last.lParam & fmap[i].flag) {
+					if (Tcl_ListObjAppendElement(interp, flagsObj,
+							Tcl_NewStringObj(fmap[i].name,
+								-1)) != TCL_OK) {
+						return TCL_ERROR;
+					}
+				}
+			}
+			elems[1] = flagsObj;
+
+			Tcl_SetObjResult(interp, Tcl_NewListObj(2, elems));
+			return TCL_OK;
+		}
+		break;
+
+		case INF_POWER: {
+			SYSTEM_POWER_STATUS power;
+
+			if (!Winpm_GetPowerStatus(statePtr, &power)) {
+				Tcl_ResetResult(statePtr->interp);
+				Winpm_AppendSystemError(statePtr->interp, GetLastError());
+				return TCL_ERROR;
+			}
+
+			Tcl_SetObjResult(interp, Winpm_NewPowerStatusObj(&power));
+			return TCL_OK;
+		}
+		break;
+
+		case INF_ID: {
+			char buf[sizeof("0xFFFFFFFF")];
+
+			/* The window is created if needed but not kept for long */
+			if (Winpm_HoldMonitor(statePtr) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			sprintf(buf, "0x%08X", (unsigned) statePtr->hwndMonitor);
+			Winpm_ReleaseMonitor(statePtr);
+			Tcl_SetObjResult(interp, Tcl_NewStringObj(buf, -1));
+			return TCL_OK;
+		}
+		break;
+
+		case INF_BINDING: {
+			Winpm_EventType *typePtr;
+			Winpm_Binding *bindPtr;
+			Tcl_Obj *elems[12];
+			int n;
+
+			if (objc != 4) {
+				Tcl_WrongNumArgs(interp, 3, objv, "event");
+				return TCL_ERROR;
+			}
+			if (Winpm_GetEventTypeFromObj(interp, objv[3],
+					&typePtr) != TCL_OK) {
+				return TCL_ERROR;
+			}
+
+			bindPtr = Winpm_FindBinding(statePtr, typePtr);
+			if (bindPtr == NULL) {
+				Tcl_AppendResult(interp, "no script is bound to ",
+						typePtr->name, NULL);
+				return TCL_ERROR;
+			}
+
+			elems[0] = Tcl_NewStringObj(BindOptions[BOPT_BUDGET], -1);
+			elems[1] = Winpm_NewIntervalObj(bindPtr->budget);
+			elems[2] = Tcl_NewStringObj(BindOptions[BOPT_ON], -1);
+			elems[3] = Winpm_NewPowerFieldsObj(bindPtr->fields);
+			n = 4;
+			if (typePtr->flags & WINPM_EVENT_SAMPLED) {
+				elems[n++] = Tcl_NewStringObj(
+						BindOptions[BOPT_THRESHOLD], -1);
+				elems[n++] = Tcl_NewIntObj(bindPtr->threshold);
+				elems[n++] = Tcl_NewStringObj(
+						BindOptions[BOPT_WINDOW], -1);
+				elems[n++] = Winpm_NewIntervalObj(bindPtr->window);
+			} else if (typePtr->flags & WINPM_EVENT_RESUME) {
+				elems[n++] = Tcl_NewStringObj(
+						BindOptions[BOPT_SPREAD], -1);
+				elems[n++] = Tcl_NewStringObj(
+						SpreadNames[bindPtr->spread], -1);
+				elems[n++] = Tcl_NewStringObj(
+						BindOptions[BOPT_STAGGER], -1);
+				elems[n++] = Winpm_NewIntervalObj(bindPtr->stagger);
+			}
+			if (bindPtr->async) {
+				elems[n++] = Tcl_NewStringObj(
+						BindOptions[BOPT_ASYNC], -1);
+				elems[n++] = Tcl_NewBooleanObj(1);
+			}
+
+			Tcl_SetObjResult(interp, Tcl_NewListObj(n, elems));
+			return TCL_OK;
+		}
+		break;
+
+		case INF_QUEUE:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult(interp, Winpm_NewQueueInfoObj(statePtr));
+			return TCL_OK;
+		break;
+
+		case INF_PROFILE:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult(interp, Winpm_NewProfileObj(statePtr));
+			return TCL_OK;
+		break;
+
+		case INF_IDLE:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult(interp,
+					Tcl_NewLongObj(Winpm_GetIdleTime(statePtr)));
+			return TCL_OK;
+		break;
+
+		case INF_ASYNC:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult(interp, Winpm_NewAsyncInfoObj(statePtr));
+			return TCL_OK;
+		break;
+
+		case INF_BROKER:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult(interp, Winpm_NewBrokerInfoObj(statePtr));
+			return TCL_OK;
+		break;
+
+		case INF_STATS: {
+			Winpm_EventType *typePtr;
+			Winpm_Binding *bindPtr;
+			Tcl_Obj *listObj;
+			int id;
+
+			if (objc > 4) {
+				Tcl_WrongNumArgs(interp, 3, objv, "?event?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 4) {
+				if (Winpm_GetEventTypeFromObj(interp, objv[3],
+						&typePtr) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				bindPtr = Winpm_FindBinding(statePtr, typePtr);
+				if (bindPtr == NULL) {
+					Tcl_AppendResult(interp, "no script is bound to ",
+							typePtr->name, NULL);
+					return TCL_ERROR;
+				}
+				Tcl_SetObjResult(interp, Winpm_NewStatsObj(bindPtr));
+				return TCL_OK;
+			}
+
+			listObj = Tcl_NewListObj(0, NULL);
+			for (id = 0; id < Winpm_CountEvents(); ++id) {
+				bindPtr = statePtr->bindings[id];
+				if (bindPtr == NULL) continue;
+				Tcl_ListObjAppendElement(interp, listObj,
+						Tcl_NewStringObj(Winpm_GetEventType(id)->name, -1));
+				Tcl_ListObjAppendElement(interp, listObj,
+						Winpm_NewStatsObj(bindPtr));
+			}
+			Tcl_SetObjResult(interp, listObj);
+			return TCL_OK;
+		}
+		break;
+	}
+
+	return TCL_OK;
+}
+
+/* winpm _injectwm uMsg wParam lParam */
+static int
+Winpm_CmdInjectWM (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	UINT    uMsg;
+	WPARAM  wParam;
+	LPARAM  lParam;
+	LRESULT res;
+
+	if (objc != 5) {
+		Tcl_WrongNumArgs(interp, 2, objv, "uMsg wParam lParam");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIntFromObj(interp, objv[2], &uMsg) != TCL_OK
+			|| Tcl_GetIntFromObj(interp, objv[3], &wParam) != TCL_OK
+			|| Tcl_GetLongFromObj(interp, objv[4], &lParam) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	if (Winpm_HoldMonitor(statePtr) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	/* FIXME is it possible for SendMessage to return error? */
+	res = SendMessage(statePtr->hwndMonitor, uMsg, wParam, lParam);
+	Winpm_ReleaseMonitor(statePtr);
+
+	Tcl_SetObjResult(interp, Tcl_NewLongObj(res));
+	return TCL_OK;
+}
+
+/*
+ * winpm _monitor
+ *
+ * Tells whether the monitoring window exists and how many users hold it.
+ */
+static int
+Winpm_CmdMonitor (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Tcl_Obj *elems[4];
+
+	if (objc != 2) {
+		Tcl_WrongNumArgs(interp, 2, objv, NULL);
+		return TCL_ERROR;
+	}
+
+	elems[0] = Tcl_NewStringObj("window", -1);
+	elems[1] = Tcl_NewBooleanObj(statePtr->hwndMonitor != NULL);
+	elems[2] = Tcl_NewStringObj("holds", -1);
+	elems[3] = Tcl_NewIntObj(statePtr->holds);
+
+	Tcl_SetObjResult(interp, Tcl_NewListObj(4, elems));
+	return TCL_OK;
+}
+
+static int
+Winpm_Cmd (
+	ClientData clientData,
+	Tcl_Interp *interp,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *options[] = { "after", "attach", "bind", "chan",
+		"connect", "deliver", "errors", "history", "idle", "info", "inhibit",
+		"listen", "publish", "schedule", "serve", "shutdown", "thermal",
+		"_injectwm", "_queue", "_power", "_subscribe", "_setting",
+		"_thermal", "_memory", "_inhibit", "_suspended", "_idle",
+		"_monitor", "_history", "_timechange", "_resolve", NULL };
+	typedef enum { WPM_AFTER, WPM_ATTACH, WPM_BIND, WPM_CHAN, WPM_CONNECT,
+		WPM_DELIVER, WPM_ERRORS, WPM_HISTORY, WPM_IDLE, WPM_INFO,
+		WPM_INHIBIT, WPM_LISTEN, WPM_PUBLISH, WPM_SCHEDULE, WPM_SERVE,
+		WPM_SHUTDOWN, WPM_THERMAL,
+		WPM_INJECTWM, WPM_QUEUE,
+		WPM_POWER, WPM_SUBSCRIBE, WPM_SETTING, WPM_THERMALSAMPLE,
+		WPM_MEMORYSAMPLE, WPM_INHIBITCOUNT, WPM_SUSPENDED,
+		WPM_IDLETIME, WPM_MONITOR, WPM_HISTORYSAMPLE,
+		WPM_TIMECHANGE, WPM_RESOLVE } WPM_Option;
+	int opt;
+	Winpm_InterpData *statePtr;
+
+	if (objc == 1) {
+		Tcl_WrongNumArgs(interp, 1, objv,
+				"option ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[1], options, "option",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	statePtr = (Winpm_InterpData *) clientData;
+
+	switch (opt) {
+		case WPM_AFTER:
+			return Winpm_CmdAfter(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_ATTACH:
+			return Winpm_CmdShared(interp, statePtr, 0, objc, objv);
+		break;
+
+		case WPM_BIND:
+			return Winpm_CmdBind(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_CHAN:
+			return Winpm_CmdChan(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_CONNECT:
+			return Winpm_CmdBroker(interp, statePtr, 0, objc, objv);
+		break;
+
+		case WPM_DELIVER:
+			return Winpm_CmdDeliver(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_ERRORS:
+			return Winpm_CmdErrors(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_HISTORY:
+			return Winpm_CmdHistory(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_IDLE:
+			return Winpm_CmdIdle(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_INFO:
+			return Winpm_CmdInfo(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_INHIBIT:
+			return Winpm_CmdInhibit(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_LISTEN:
+			return Winpm_CmdListen(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_PUBLISH:
+			return Winpm_CmdShared(interp, statePtr, 1, objc, objv);
+		break;
+
+		case WPM_SCHEDULE:
+			return Winpm_CmdSchedule(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_SERVE:
+			return Winpm_CmdBroker(interp, statePtr, 1, objc, objv);
+		break;
+
+		case WPM_SHUTDOWN:
+			return Winpm_CmdShutdown(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_THERMAL:
+			return Winpm_CmdThermal(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_INJECTWM:
+			return Winpm_CmdInjectWM(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_QUEUE:
+			return Winpm_CmdQueue(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_POWER:
+			return Winpm_CmdPower(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_SUBSCRIBE:
+			return Winpm_CmdSubscribe(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_SETTING:
+			return Winpm_CmdSetting(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_THERMALSAMPLE:
+			return Winpm_CmdThermalSample(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_MEMORYSAMPLE:
+			return Winpm_CmdMemorySample(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_INHIBITCOUNT:
+			return Winpm_CmdInhibitCount(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_SUSPENDED:
+			return Winpm_CmdSuspended(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_IDLETIME:
+			return Winpm_CmdIdleTime(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_MONITOR:
+			return Winpm_CmdMonitor(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_HISTORYSAMPLE:
+			return Winpm_CmdHistorySample(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_TIMECHANGE:
+			return Winpm_CmdTimeChange(interp, statePtr, objc, objv);
+		break;
+
+		case WPM_RESOLVE:
+			return Winpm_CmdResolve(interp, statePtr, objc, objv);
+		break;
+	}
+
+	return TCL_OK;
+}
+
+/*
+ * Decoder of PBT_APMPOWERSTATUSCHANGE: takes the new snapshot of the
+ * power status and fills in the event description from it.
+ */
+static int
+DecodeStatus (
+	Winpm_InterpData *statePtr,
+	LPARAM lParam,
+	Winpm_Event *eventPtr,
+	Winpm_EventType **detailPtr
+	)
+{
+	SYSTEM_POWER_STATUS *statusPtr = &statePtr->power.snapshot;
+
+	eventPtr->power.changed = Winpm_UpdatePowerSnapshot(statePtr);
+	if (eventPtr->power.changed > 0) {
+		Winpm_RescheduleJobs(statePtr);
+		Winpm_UpdateBatches(statePtr);
+		Winpm_PublishPower(statePtr);
+		Winpm_RecordPower(statePtr);
+	}
+	if (eventPtr->power.changed != -1) {
+		eventPtr->power.acLine = statusPtr->ACLineStatus;
+		eventPtr->power.batteryFlag = statusPtr->BatteryFlag;
+		eventPtr->power.batteryPercent =
+			Winpm_BatteryPercent(statusPtr->BatteryLifePercent);
+		eventPtr->power.batteryLifeTime = (long) statusPtr->BatteryLifeTime;
+	}
+
+	return 1;
+}
+
+/* Decoder of PBT_APMOEMEVENT: lParam holds the OEM event code */
+static int
+DecodeOem (
+	Winpm_InterpData *statePtr,
+	LPARAM lParam,
+	Winpm_Event *eventPtr,
+	Winpm_EventType **detailPtr
+	)
+{
+	eventPtr->oemCode = (long) lParam;
+	return 1;
+}
+
+/* Tells whether a script is bound to the event of the type, if any */
+static int
+IsBound (
+	Winpm_InterpData *statePtr,
+	CONST Winpm_EventType *typePtr
+	)
+{
+	return typePtr != NULL && Winpm_FindBinding(statePtr, typePtr) != NULL;
+}
+
+static LRESULT
+Winpm_ProcessPowerBcast (
+	Winpm_InterpData *statePtr,
+	WPARAM wParam,
+	LPARAM lParam
+	)
+{
+	Winpm_EventType *classPtr, *detailPtr;
+	Winpm_Event event;
+	Winpm_PercentMap map[6], *mapPtr;
+	char percent[TCL_INTEGER_SPACE], lifetime[TCL_INTEGER_SPACE];
+	char saver[TCL_INTEGER_SPACE];
+	Tcl_Obj *changedObj;
+	int denied;
+
+	memset(&event, 0, sizeof(event));
+	event.power.changed = -1;
+	detailPtr = NULL;
+
+	classPtr = Winpm_LookupEvent(WM_POWERBROADCAST, wParam);
+	if (classPtr != NULL) {
+		event.type = classPtr->type;
+		if (classPtr->decodeProc != NULL && !classPtr->decodeProc(statePtr,
+				lParam, &event, &detailPtr)) {
+			/* The message only stands for the detail, like the lid */
+			classPtr = NULL;
+		}
+	}
+
+	mapPtr = NULL;
+	changedObj = NULL;
+
+	/* Substitutions are only prepared if there's a script to get them */
+	if (event.type == WINPM_POWERSTATUSCHANGE && event.power.changed != -1
+			&& (IsBound(statePtr, &CoreEvents[EV_POWERBROADCAST])
+				|| IsBound(statePtr, classPtr))) {
+		sprintf(percent, "%d", event.power.batteryPercent);
+		sprintf(lifetime, "%ld", event.power.batteryLifeTime);
+		changedObj = Winpm_NewPowerFieldsObj(event.power.changed);
+		Tcl_IncrRefCount(changedObj);
+
+		map[0].token = 'a';
+		map[0].value = Winpm_ACLineStatusName((BYTE) event.power.acLine);
+		map[1].token = 'b';
+		map[1].value = Winpm_BatteryFlagName((BYTE) event.power.batteryFlag);
+		map[2].token = 'p';
+		map[2].value = percent;
+		map[3].token = 'l';
+		map[3].value = lifetime;
+		map[4].token = 'c';
+		map[4].value = Tcl_GetString(changedObj);
+		map[5].token = '\0';
+		mapPtr = map;
+	}
+
+	if (event.type == WINPM_PROFILECHANGE
+			&& (IsBound(statePtr, &CoreEvents[EV_POWERBROADCAST])
+				|| IsBound(statePtr, classPtr)
+				|| IsBound(statePtr, detailPtr))) {
+		sprintf(saver, "%d", event.profile.saver);
+
+		map[0].token = 'n';
+		map[0].value = Winpm_ProfileName(event.profile.personality);
+		map[1].token = 's';
+		map[1].value = saver;
+		map[2].token = '\0';
+		mapPtr = map;
+	}
+
+	if (event.type == WINPM_POWERSOURCE) {
+		map[0].token = 'a';
+		map[0].value = Winpm_PowerSourceName(event.source);
+		map[1].token = '\0';
+		mapPtr = map;
+	}
+
+	/* Timers should be right by the time scripts learn of the resume */
+	if (classPtr != NULL && (classPtr->flags & WINPM_EVENT_RESUME)) {
+		Winpm_ResumeTimers(statePtr);
+	}
+
+	denied = 0;
+	if (event.type != 0) {
+		denied = Winpm_NotifySubscribers(statePtr, &event) == TCL_CONTINUE;
+	}
+
+	if (Winpm_DispatchPowerBcast(statePtr, mapPtr, event.power.changed,
+			classPtr) == TCL_CONTINUE) {
+		denied = 1;
+	}
+
+	if (detailPtr != NULL) {
+		Winpm_DispatchEvent(statePtr, mapPtr, -1, detailPtr);
+	}
+
+	if (changedObj != NULL) {
+		Tcl_DecrRefCount(changedObj);
+	}
+
+	if (classPtr != NULL && (classPtr->flags & WINPM_EVENT_QUERY) && denied) {
+		return BROADCAST_QUERY_DENY;
+	}
+	return TRUE;
+}
+
+static Winpm_InterpData*
+GetWindowInterpData (
+	HWND hwnd)
+{
+	return (Winpm_InterpData *)GetWindowLongPtr(hwnd, GWLP_USERDATA);
+}
+
+static void
+SaveLastMessage (
+	Winpm_InterpData *statePtr,
+	UINT uMsg,
+	WPARAM wParam,
+	LPARAM lParam
+	)
+{
+	statePtr->last.uMsg   = uMsg;
+	statePtr->last.wParam = wParam;
+	statePtr->last.lParam = lParam;
+}
+
+/*
+ * Runs the scripts bound to the events the message represents.
+ * Called by the event queue either right from the window procedure
+ * or later, when the message had to wait for its turn.
+ */
+LRESULT
+Winpm_ProcessMessage (
+	Winpm_InterpData *statePtr,
+	UINT uMsg,
+	WPARAM wParam,
+	LPARAM lParam
+	)
+{
+	Winpm_Event event;
+
+	/* Timers are ours, not the system's notifications */
+	if (uMsg == WM_TIMER) {
+		if (wParam == WINPM_TIMER_THERMAL) {
+			Winpm_SampleThermal(statePtr);
+		} else if (wParam == WINPM_TIMER_MEMORY) {
+			Winpm_SampleMemory(statePtr);
+		} else if (wParam == WINPM_TIMER_IDLE) {
+			Winpm_SampleIdle(statePtr);
+		}
+		return 0;
+	}
+
+	SaveLastMessage(statePtr, uMsg, wParam, lParam);
+
+	memset(&event, 0, sizeof(event));
+	event.session.flags = (unsigned long) lParam;
+	event.power.changed = -1;
+
+	switch (uMsg) {
+		case WM_QUERYENDSESSION: {
+			int denied;
+
+			event.type = WINPM_QUERYENDSESSION;
+			denied = Winpm_NotifySubscribers(statePtr,
+					&event) == TCL_CONTINUE;
+			if (Winpm_DispatchEvent(statePtr, NULL, -1,
+					&CoreEvents[EV_QUERYENDSESSION]) == TCL_CONTINUE) {
+				denied = 1;
+			}
+			return !denied;
+		}
+		break;
+
+		case WM_ENDSESSION:
+			if (wParam) {
+				Winpm_RunShutdownPhase(statePtr);
+			}
+			event.type = WINPM_ENDSESSION;
+			event.session.final = wParam != 0;
+			Winpm_NotifySubscribers(statePtr, &event);
+			Winpm_DispatchEvent(statePtr, NULL, -1,
+					&CoreEvents[EV_ENDSESSION]);
+			Winpm_FlushBatches(statePtr);
+			return 0;
+		break;
+
+		case WM_POWERBROADCAST:
+			/* A client gets these from its broker instead */
+			if (Winpm_IsRelayed(statePtr, wParam)) {
+				return TRUE;
+			}
+			return Winpm_ProcessPowerBcast(statePtr, wParam, lParam);
+		break;
+
+		case WM_TIMECHANGE: {
+			Winpm_PercentMap map[2];
+			char step[TCL_INTEGER_SPACE];
+
+			/* Wall clock timers may have become due or far from it */
+			event.type = WINPM_TIMECHANGE;
+			event.step = (long) Winpm_TakeClockStep(statePtr);
+			Winpm_ResumeTimers(statePtr);
+
+			sprintf(step, "%ld", event.step);
+			map[0].token = 'd';
+			map[0].value = step;
+			map[1].token = '\0';
+			Winpm_FireEvent(statePtr, &event, map,
+					&CoreEvents[EV_TIMECHANGE]);
+			return 0;
+		}
+		break;
+
+		case WM_WTSSESSION_CHANGE:
+			Winpm_ProcessSessionChange(statePtr, wParam, lParam);
+			return 0;
+		break;
+	}
+
+	return 0;
+}
+
+static LRESULT CALLBACK
+WndProc(
+	HWND hwnd,
+	UINT uMsg,
+	WPARAM wParam,
+	LPARAM lParam
+	)
+{
+	switch (uMsg) {
+		case WM_QUERYENDSESSION:
+		case WM_ENDSESSION:
+		case WM_POWERBROADCAST:
+		case WM_TIMECHANGE:
+		case WM_WTSSESSION_CHANGE:
+		case WM_TIMER:
+			return Winpm_QueueMessage(GetWindowInterpData(hwnd),
+					uMsg, wParam, lParam);
+		break;
+
+		default:
+			return DefWindowProc(hwnd, uMsg, wParam, lParam);
+	}
+}
+
+static int
+CreateMonitorWindow (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr)
+{
+	CONST TCHAR name[]  = _T("TkWinPMMonitorWindow");
+	CONST TCHAR title[] = _T("TkWinPMMonitorWindow");
+
+	HINSTANCE   hinst;
+	WNDCLASSEX  wc;
+	ATOM        rc;
+	HWND        hwnd;
+
+	hinst = Tk_GetHINSTANCE();
+
+	memset(&wc, 0, sizeof(wc));
+	wc.cbSize = sizeof(wc);
+
+	Tcl_MutexLock(&global);
+	if (!GetClassInfoEx(hinst, name, &wc)) {
+		if (GetLastError() != ERROR_CLASS_DOES_NOT_EXIST) {
+			Tcl_MutexUnlock(&global);
+			Tcl_ResetResult(interp);
+			Winpm_AppendSystemError(interp, GetLastError());
+			return TCL_ERROR;
+		}
+		wc.style         = CS_HREDRAW | CS_VREDRAW;
+		wc.lpfnWndProc   = (WNDPROC) WndProc;
+		wc.cbClsExtra    = 0;
+		wc.cbWndExtra    = 0;
+		wc.hInstance     = hinst;
+		wc.hIcon         = LoadIcon(NULL, IDI_APPLICATION);
+		wc.hIconSm       = LoadIcon(NULL, IDI_APPLICATION);
+		wc.hCursor       = LoadCursor(NULL, IDC_ARROW);
+		wc.hbrBackground = (HBRUSH) COLOR_WINDOW;
+		wc.lpszMenuName  = name;
+		wc.lpszClassName = name;
+
+		rc = RegisterClassEx(&wc);
+		if (rc == 0) {
+			Tcl_MutexUnlock(&global);
+			Tcl_ResetResult(interp);
+			Winpm_AppendSystemError(interp, GetLastError());
+			return TCL_ERROR;
+		}
+	}
+	Tcl_MutexUnlock(&global);
+
+	if (wc.lpfnWndProc != (WNDPROC) WndProc) {
+		Tcl_SetResult(interp,
+				"Monitoring window class already registered\
+				by a foreign code", TCL_STATIC);
+		return TCL_ERROR;
+	}
+
+	hwnd = CreateWindow(name, title, WS_OVERLAPPEDWINDOW,
+		CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT,
+		NULL, NULL, hinst, NULL);
+	if (hwnd == NULL) {
+		Tcl_ResetResult(interp);
+		Winpm_AppendSystemError(interp, GetLastError());
+		return TCL_ERROR;
+	}
+
+	SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG)statePtr);
+
+	ShowWindow(hwnd, SW_HIDE);
+	UpdateWindow(hwnd);
+
+	statePtr->hwndMonitor = hwnd;
+	Winpm_RegisterSettings(statePtr);
+	Winpm_RegisterSession(statePtr);
+
+	return TCL_OK;
+}
+
+static void
+DestroyMonitorWindow (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_UnregisterSettings(statePtr);
+	Winpm_UnregisterSession(statePtr);
+	DestroyWindow(statePtr->hwndMonitor);
+	statePtr->hwndMonitor = NULL;
+}
+
+/*
+ * Destroys the monitoring window nobody uses anymore. Deferred to
+ * the idle time since the last user may go away while the window
+ * procedure is still running, and so that dropping and immediately
+ * re-creating a binding doesn't re-create the window.
+ */
+static void
+DestroyUnusedMonitor (
+	ClientData clientData
+	)
+{
+	Winpm_InterpData *statePtr = (Winpm_InterpData *) clientData;
+
+	if (statePtr->holds == 0 && statePtr->hwndMonitor != NULL) {
+		DestroyMonitorWindow(statePtr);
+	}
+}
+
+/*
+ * The monitoring window only exists while something needs it: a binding,
+ * a subscriber, a shutdown handler, a scheduled job, a batched channel
+ * or thermal sampling.
+ * Each of them holds the window while it exists; the window is created
+ * by the first hold and destroyed some time after the last release.
+ * Returns TCL_ERROR, leaving the message in the interpreter, if the
+ * window couldn't be created.
+ */
+int
+Winpm_HoldMonitor (
+	Winpm_InterpData *statePtr
+	)
+{
+	if (statePtr->hwndMonitor == NULL
+			&& CreateMonitorWindow(statePtr->interp, statePtr) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	++statePtr->holds;
+	return TCL_OK;
+}
+
+void
+Winpm_ReleaseMonitor (
+	Winpm_InterpData *statePtr
+	)
+{
+	if (--statePtr->holds == 0) {
+		Tcl_CancelIdleCall(DestroyUnusedMonitor, (ClientData) statePtr);
+		Tcl_DoWhenIdle(DestroyUnusedMonitor, (ClientData) statePtr);
+	}
+}
+
+static void
+Winpm_Cleanup(ClientData clientData)
+{
+	Winpm_InterpData *statePtr = (Winpm_InterpData *) clientData;
+	int id;
+
+	Winpm_FinalizeBroker(statePtr);
+	Winpm_FinalizeListen(statePtr);
+	Winpm_FinalizeAsync(statePtr);
+	Winpm_FinalizeShared(statePtr);
+	Winpm_FinalizeHistory(statePtr);
+	Winpm_FinalizeIdle(statePtr);
+	Winpm_FinalizeErrors(statePtr);
+	Winpm_FinalizeAfter(statePtr);
+	Winpm_FinalizeInhibit(statePtr);
+	Winpm_FinalizeSchedule(statePtr);
+	Winpm_FinalizeChan(statePtr);
+	Winpm_FinalizeThermal(statePtr);
+	Winpm_FinalizeNotify(statePtr);
+	Winpm_FinalizeQueue(statePtr);
+	Winpm_FinalizeShutdown(statePtr);
+	while (statePtr->staggered != NULL) {
+		Tcl_DeleteTimerHandler(statePtr->staggered->token);
+		Winpm_FreeStaggered(statePtr->staggered);
+	}
+	for (id = 0; id < Winpm_CountEvents(); ++id) {
+		if (statePtr->bindings[id] != NULL) {
+			Tcl_EventuallyFree((ClientData) statePtr->bindings[id],
+					FreeBinding);
+		}
+	}
+	Tcl_CancelIdleCall(DestroyUnusedMonitor, (ClientData) statePtr);
+	if (statePtr->hwndMonitor != NULL) {
+		DestroyMonitorWindow(statePtr);
+	}
+
+	/* The command may be gone while the interpreter lives on; the C
+	 * interface must not find the state there any longer */
+	Tcl_DeleteAssocData(statePtr->interp, WINPM_ASSOC_KEY);
+	ckfree((char *) statePtr);
+}
+
+#ifdef BUILD_winpm
+#undef TCL_STORAGE_CLASS
+#define TCL_STORAGE_CLASS DLLEXPORT
+#endif /* BUILD_winpm */
+
+EXTERN int
+Winpm_Init(Tcl_Interp * interp)
+{
+	Winpm_InterpData *statePtr;
+
+#ifdef USE_TCL_STUBS
+	if (Tcl_InitStubs(interp, "8.5", 0) == NULL) {
+		return TCL_ERROR;
+	}
+#endif
+	if (Tcl_PkgRequire(interp, "Tcl", "8.5", 0) == NULL) {
+		return TCL_ERROR;
+	}
+
+#ifdef USE_TK_STUBS
+	if (Tk_InitStubs(interp, "8.1", 0) == NULL) {
+		return TCL_ERROR;
+	}
+#endif
+	if (Tcl_PkgRequire(interp, "Tk", "8.1", 0) == NULL) {
+		return TCL_ERROR;
+	}
+
+	statePtr = (Winpm_InterpData *) ckalloc(sizeof(Winpm_InterpData));
+	memset(statePtr, 0, sizeof(*statePtr));
+
+	statePtr->interp = interp;
+
+	/* The monitoring window is created on demand */
+	Winpm_RegisterEvents(CoreEvents);
+	Winpm_InitNotify(statePtr);
+	Winpm_InitShared(statePtr);
+	Winpm_InitHistory(statePtr);
+	Winpm_InitBroker(statePtr);
+	Winpm_InitPower(statePtr);
+	Winpm_InitQueue(statePtr);
+	Winpm_InitShutdown(statePtr);
+	Winpm_InitSettings(statePtr);
+	Winpm_InitThermal(statePtr);
+	Winpm_InitMemory(statePtr);
+	Winpm_InitSession(statePtr);
+	Winpm_InitSchedule(statePtr);
+	Winpm_InitChan(statePtr);
+	Winpm_InitInhibit(statePtr);
+	Winpm_InitAfter(statePtr);
+	Winpm_InitIdle(statePtr);
+	Winpm_InitErrors(statePtr);
+	Winpm_InitListen(statePtr);
+	Winpm_InitAsync(statePtr);
+
+	Tcl_SetAssocData(interp, WINPM_ASSOC_KEY, NULL, (ClientData) statePtr);
+
+	Tcl_CreateObjCommand(interp, "winpm", (Tcl_ObjCmdProc *) Winpm_Cmd,
+		(ClientData) statePtr, (Tcl_CmdDeleteProc *) Winpm_Cleanup);
+
+	if (Tcl_PkgProvideEx(interp, PACKAGE_NAME, PACKAGE_VERSION,
+			(ClientData) &winpmStubs) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	return TCL_OK;
+}
+
@@ -0,0 +1,147 @@
+/*
+ * winpm.h --
+ *   Public C interface of the winpm package.
+ *
+ *   Extensions using this interface should be compiled with
+ *   USE_WINPM_STUBS defined, call Winpm_InitStubs() from their
+ *   initialization procedure and link against the winpm stub library.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#ifndef _WINPM
+#define _WINPM
+
+#include <tcl.h>
+
+#ifdef BUILD_winpm
+#undef TCL_STORAGE_CLASS
+#define TCL_STORAGE_CLASS DLLEXPORT
+#endif /* BUILD_winpm */
+
+/*
+ * Shutdown handlers are run when the session is really ending
+ * (WM_ENDSESSION with wParam set). Handlers registered from C are run
+ * on worker threads concurrently with each other and with the handlers
+ * registered from Tcl, so they must not touch the interpreter.
+ * A handler should return TCL_OK on success and TCL_ERROR otherwise.
+ */
+typedef int (Winpm_ShutdownProc) (ClientData clientData);
+
+/* Types of events reported to subscribers; these are bits
+ * so they can be combined to form an event mask */
+#define WINPM_QUERYENDSESSION       (1<<0)
+#define WINPM_ENDSESSION            (1<<1)
+#define WINPM_POWERSTATUSCHANGE     (1<<2)
+#define WINPM_RESUMEAUTOMATIC       (1<<3)
+#define WINPM_RESUMESUSPEND         (1<<4)
+#define WINPM_SUSPEND               (1<<5)
+#define WINPM_BATTERYLOW            (1<<6)
+#define WINPM_OEMEVENT              (1<<7)
+#define WINPM_QUERYSUSPEND          (1<<8)
+#define WINPM_QUERYSUSPENDFAILED    (1<<9)
+#define WINPM_RESUMECRITICAL        (1<<10)
+#define WINPM_PROFILECHANGE         (1<<11)
+#define WINPM_THERMALTHRESHOLD      (1<<12)
+#define WINPM_THERMALTRIP           (1<<13)
+#define WINPM_THERMALTHROTTLE       (1<<14)
+#define WINPM_MEMORYPRESSURE        (1<<15)
+#define WINPM_USERIDLE              (1<<16)
+#define WINPM_USERACTIVE            (1<<17)
+#define WINPM_LIDCLOSE              (1<<18)
+#define WINPM_LIDOPEN               (1<<19)
+#define WINPM_POWERSOURCE           (1<<20)
+#define WINPM_TIMECHANGE            (1<<21)
+#define WINPM_SESSIONLOCK           (1<<22)
+#define WINPM_SESSIONUNLOCK         (1<<23)
+#define WINPM_SESSIONSWITCH         (1<<24)
+#define WINPM_ALL_EVENTS            0x1FFFFFF
+
+/* Fields of the power status tracked for changes */
+#define WINPM_POWER_AC       (1<<0)
+#define WINPM_POWER_BATTERY  (1<<1)
+#define WINPM_POWER_PERCENT  (1<<2)
+#define WINPM_POWER_LIFETIME (1<<3)
+#define WINPM_POWER_ALL      0x0F
+
+/* Personalities of the active power scheme */
+#define WINPM_PROFILE_UNKNOWN     0
+#define WINPM_PROFILE_POWERSAVER  1
+#define WINPM_PROFILE_BALANCED    2
+#define WINPM_PROFILE_PERFORMANCE 3
+
+/* Sources of power, as in SYSTEM_POWER_CONDITION */
+#define WINPM_SOURCE_AC  0
+#define WINPM_SOURCE_DC  1
+#define WINPM_SOURCE_UPS 2
+
+/* Decoded event passed to subscribers */
+typedef struct Winpm_Event {
+	int type; /* One of WINPM_* event types */
+	struct {
+		int final; /* The session is really ending */
+		unsigned long flags; /* ENDSESSION_* bits */
+	} session; /* WINPM_QUERYENDSESSION, WINPM_ENDSESSION */
+	struct {
+		int changed; /* WINPM_POWER_* bits, -1 if status is unknown */
+		int acLine; /* 0 = offline, 1 = online, 255 = unknown */
+		int batteryFlag; /* As in SYSTEM_POWER_STATUS */
+		int batteryPercent; /* -1 if unknown */
+		long batteryLifeTime; /* In seconds, -1 if unknown */
+	} power; /* WINPM_POWERSTATUSCHANGE */
+	long oemCode; /* WINPM_OEMEVENT */
+	struct {
+		int personality; /* WINPM_PROFILE_* */
+		int saver; /* Energy saver is on, -1 if unknown */
+	} profile; /* WINPM_PROFILECHANGE */
+	struct {
+		CONST char *zone; /* Name of the thermal zone */
+		int temperature; /* Degrees Celsius */
+		int passiveLimit; /* Percents of the full processor speed */
+	} thermal; /* WINPM_THERMAL* */
+	struct {
+		int load; /* Percents of physical memory in use */
+		long available; /* Free physical memory in megabytes */
+	} memory; /* WINPM_MEMORYPRESSURE */
+	struct {
+		long time; /* Milliseconds since the last input */
+	} idle; /* WINPM_USERIDLE, WINPM_USERACTIVE */
+	int source; /* WINPM_POWERSOURCE: WINPM_SOURCE_* */
+	long step; /* WINPM_TIMECHANGE: milliseconds the time moved forward */
+	struct {
+		int reason; /* WTS_* code of the change */
+		unsigned long id; /* Of the session */
+	} wts; /* WINPM_SESSIONLOCK, WINPM_SESSIONUNLOCK, WINPM_SESSIONSWITCH */
+} Winpm_Event;
+
+/*
+ * Subscribers are called on the thread of the interpreter they're
+ * registered with, before the scripts bound to the same event.
+ * For WINPM_QUERYENDSESSION and WINPM_QUERYSUSPEND returning
+ * TCL_CONTINUE denies the request, just like [continue] in a script;
+ * otherwise the return value is ignored.
+ */
+typedef int (Winpm_EventProc) (ClientData clientData,
+		CONST Winpm_Event *eventPtr);
+
+EXTERN int Winpm_Init (Tcl_Interp *interp);
+
+#ifdef USE_WINPM_STUBS
+extern CONST char *Winpm_InitStubs (Tcl_Interp *interp,
+		CONST char *version, int exact);
+#else
+#define Winpm_InitStubs(interp, version, exact) \
+	Tcl_PkgRequire(interp, "winpm", version, exact)
+#endif
+
+#include "winpmDecls.h"
+
+#undef TCL_STORAGE_CLASS
+#define TCL_STORAGE_CLASS DLLIMPORT
+
+#endif /* _WINPM */
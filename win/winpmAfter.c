@@ -0,0 +1,589 @@
+/*
+ * winpmAfter.c --
+ *   Suspend-aware timers.
+ *
+ *   Timers of the Tcl timer queue know nothing about the time the
+ *   system spends suspended, so after resuming they either all fire at
+ *   once or drift. Timers created with [winpm after] are measured by
+ *   one of three clocks: the monotonic clock which stops while the
+ *   system is suspended, the suspend-inclusive clock which doesn't, and
+ *   the wall clock which also follows changes of the system time. The
+ *   Tcl timer queue is only used to wake up; on each wakeup the timer
+ *   checks its own clock and goes back to sleep if it's not yet due.
+ *
+ *   When the system resumes (which is learned from the resume
+ *   notifications or, should they not arrive, from the growing
+ *   difference between the suspend-inclusive and the monotonic clocks)
+ *   all timers are re-armed and those which became overdue while the
+ *   system was suspended are handled according to their policy. The
+ *   same is done when the system time is changed (WM_TIMECHANGE), whose
+ *   step is the change of the difference between the wall and the
+ *   suspend-inclusive clocks.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+#include <limits.h>
+
+typedef enum {
+	CLOCK_MONOTONIC,
+	CLOCK_SUSPEND,
+	CLOCK_WALL
+} Clock;
+
+typedef enum {
+	OVERDUE_ONCE,
+	OVERDUE_SKIP,
+	OVERDUE_CATCHUP
+} Overdue;
+
+static const char *Clocks[] = { "monotonic", "suspend", "wall", NULL };
+static const char *Policies[] = { "once", "skip", "catchup", NULL };
+
+/* Growth of the suspended time taken for a resume, milliseconds */
+#define RESUME_GAP 2000
+
+typedef struct {
+	Winpm_InterpData *statePtr;
+	Tcl_HashEntry *entryPtr; /* NULL once the timer is gone */
+	Tcl_Obj *scriptObj;
+	Clock clock;
+	Overdue overdue;
+	int repeat; /* Set if the timer is periodic */
+	Tcl_WideInt interval; /* Milliseconds */
+	Tcl_WideInt deadline; /* By the timer's clock, milliseconds */
+	Tcl_TimerToken token; /* Wakeup in the Tcl timer queue or NULL */
+} Timer;
+
+/* Looked up at runtime since they're missing before Vista and 7 */
+typedef ULONGLONG (WINAPI *GetTickCount64Proc) (void);
+typedef BOOL (WINAPI *QueryUnbiasedProc) (ULONGLONG *);
+
+static void WakeUp (ClientData clientData);
+
+/*
+ * Returns the current time by the clock in milliseconds. The results
+ * of the lookups are the same for all threads, so racing is harmless.
+ */
+static Tcl_WideInt
+Now (
+	Winpm_InterpData *statePtr,
+	Clock clock
+	)
+{
+	static int looked = 0;
+	static GetTickCount64Proc tickProc;
+	static QueryUnbiasedProc unbiasedProc;
+	Tcl_WideInt ms;
+
+	if (!looked) {
+		HMODULE hmod = GetModuleHandle(_T("kernel32.dll"));
+
+		tickProc = (GetTickCount64Proc)
+			GetProcAddress(hmod, "GetTickCount64");
+		unbiasedProc = (QueryUnbiasedProc)
+			GetProcAddress(hmod, "QueryUnbiasedInterruptTime");
+		looked = 1;
+	}
+
+	switch (clock) {
+		case CLOCK_MONOTONIC: {
+			ULONGLONG t;
+
+			if (unbiasedProc != NULL && unbiasedProc(&t)) {
+				/* Units of 100 nanoseconds */
+				return (Tcl_WideInt) (t / 10000);
+			}
+		}
+		/* No way to tell the suspended time; fall through */
+
+		case CLOCK_SUSPEND:
+			if (tickProc != NULL) {
+				ms = (Tcl_WideInt) tickProc();
+			} else {
+				ms = (Tcl_WideInt) GetTickCount();
+			}
+		break;
+
+		default: {
+			Tcl_Time now;
+
+			Tcl_GetTime(&now);
+			ms = (Tcl_WideInt) now.sec * 1000 + now.usec / 1000
+				+ statePtr->timers.step;
+		}
+		break;
+	}
+
+	/* Time which passed while "suspended" in the tests */
+	return ms + statePtr->timers.skew;
+}
+
+/* Milliseconds the system has spent suspended since the boot */
+static Tcl_WideInt
+SuspendedTime (
+	Winpm_InterpData *statePtr
+	)
+{
+	return Now(statePtr, CLOCK_SUSPEND) - Now(statePtr, CLOCK_MONOTONIC);
+}
+
+void
+Winpm_InitAfter (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_InitHashTable(&statePtr->timers.table, TCL_STRING_KEYS);
+	statePtr->timers.nextId = 1;
+	statePtr->timers.skew = 0;
+	statePtr->timers.step = 0;
+	statePtr->timers.suspended = SuspendedTime(statePtr);
+	statePtr->timers.offset = Now(statePtr, CLOCK_WALL)
+		- Now(statePtr, CLOCK_SUSPEND);
+}
+
+static void
+FreeTimer (
+	char *blockPtr
+	)
+{
+	Timer *timerPtr = (Timer *) blockPtr;
+
+	Tcl_DecrRefCount(timerPtr->scriptObj);
+	ckfree((char *) timerPtr);
+}
+
+static void
+DeleteTimer (
+	Timer *timerPtr
+	)
+{
+	if (timerPtr->token != NULL) {
+		Tcl_DeleteTimerHandler(timerPtr->token);
+		timerPtr->token = NULL;
+	}
+	Tcl_DeleteHashEntry(timerPtr->entryPtr);
+	timerPtr->entryPtr = NULL;
+	Tcl_EventuallyFree((ClientData) timerPtr, FreeTimer);
+}
+
+void
+Winpm_FinalizeAfter (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_HashEntry *entryPtr;
+	Tcl_HashSearch search;
+
+	entryPtr = Tcl_FirstHashEntry(&statePtr->timers.table, &search);
+	while (entryPtr != NULL) {
+		DeleteTimer((Timer *) Tcl_GetHashValue(entryPtr));
+		entryPtr = Tcl_NextHashEntry(&search);
+	}
+	Tcl_DeleteHashTable(&statePtr->timers.table);
+}
+
+/* Schedules the wakeup for the deadline of the timer */
+static void
+Arm (
+	Timer *timerPtr
+	)
+{
+	Tcl_WideInt remaining;
+
+	if (timerPtr->token != NULL) {
+		Tcl_DeleteTimerHandler(timerPtr->token);
+	}
+
+	remaining = timerPtr->deadline
+		- Now(timerPtr->statePtr, timerPtr->clock);
+	if (remaining < 0) remaining = 0;
+	if (remaining > INT_MAX) remaining = INT_MAX;
+	timerPtr->token = Tcl_CreateTimerHandler((int) remaining,
+			WakeUp, (ClientData) timerPtr);
+}
+
+/*
+ * Reconsiders all timers after the system has resumed or the system
+ * time has changed: overdue timers are handled according to their
+ * policies, the rest are re-armed.
+ */
+void
+Winpm_ResumeTimers (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_HashEntry *entryPtr;
+	Tcl_HashSearch search;
+	Timer *timerPtr;
+	Tcl_WideInt now, missed;
+
+	statePtr->timers.suspended = SuspendedTime(statePtr);
+
+	entryPtr = Tcl_FirstHashEntry(&statePtr->timers.table, &search);
+	while (entryPtr != NULL) {
+		timerPtr = (Timer *) Tcl_GetHashValue(entryPtr);
+		entryPtr = Tcl_NextHashEntry(&search);
+
+		now = Now(statePtr, timerPtr->clock);
+		if (now >= timerPtr->deadline) {
+			switch (timerPtr->overdue) {
+				case OVERDUE_ONCE:
+					timerPtr->deadline = now;
+				break;
+
+				case OVERDUE_SKIP:
+					if (!timerPtr->repeat) {
+						DeleteTimer(timerPtr);
+						continue;
+					}
+					/* Keep to the original schedule */
+					missed = (now - timerPtr->deadline)
+						/ timerPtr->interval + 1;
+					timerPtr->deadline += missed * timerPtr->interval;
+				break;
+
+				case OVERDUE_CATCHUP:
+					/* Don't let all processes catch up at once */
+					timerPtr->deadline = now
+						+ rand() % (timerPtr->interval + 1);
+				break;
+			}
+		}
+		Arm(timerPtr);
+	}
+}
+
+/*
+ * Checks whether the system has been suspended since the last check
+ * and reconsiders the timers if so. Returns 1 if it has.
+ */
+static int
+DetectResume (
+	Winpm_InterpData *statePtr
+	)
+{
+	if (SuspendedTime(statePtr) - statePtr->timers.suspended < RESUME_GAP) {
+		return 0;
+	}
+	Winpm_ResumeTimers(statePtr);
+	return 1;
+}
+
+static void
+WakeUp (
+	ClientData clientData
+	)
+{
+	Timer *timerPtr = (Timer *) clientData;
+	Winpm_InterpData *statePtr = timerPtr->statePtr;
+	Tcl_Interp *interp = statePtr->interp;
+	Tcl_WideInt now;
+	int code;
+
+	timerPtr->token = NULL;
+
+	/* The resume notification hasn't come (yet) */
+	if (DetectResume(statePtr)) return;
+
+	now = Now(statePtr, timerPtr->clock);
+	if (now < timerPtr->deadline) {
+		Arm(timerPtr);
+		return;
+	}
+
+	if (timerPtr->repeat) {
+		timerPtr->deadline += timerPtr->interval;
+		if (timerPtr->deadline <= now) {
+			timerPtr->deadline = now + timerPtr->interval;
+		}
+	}
+
+	/* The script is free to cancel its timer */
+	Tcl_Preserve((ClientData) timerPtr);
+	Tcl_Preserve((ClientData) interp);
+
+	code = Tcl_EvalObjEx(interp, timerPtr->scriptObj, TCL_EVAL_GLOBAL);
+	if (code == TCL_ERROR) {
+		Tcl_AddErrorInfo(interp, "\n    (\"" PACKAGE_NAME " after\" script)");
+		Tcl_BackgroundError(interp);
+	}
+
+	if (timerPtr->entryPtr != NULL && timerPtr->token == NULL) {
+		if (timerPtr->repeat) {
+			Arm(timerPtr);
+		} else {
+			DeleteTimer(timerPtr);
+		}
+	}
+
+	Tcl_Release((ClientData) interp);
+	Tcl_Release((ClientData) timerPtr);
+}
+
+static Tcl_Obj *
+NewTimerInfoObj (
+	Timer *timerPtr
+	)
+{
+	Tcl_Obj *elems[12];
+	Tcl_WideInt remaining;
+
+	remaining = timerPtr->deadline
+		- Now(timerPtr->statePtr, timerPtr->clock);
+	if (remaining < 0) remaining = 0;
+
+	elems[0]  = Tcl_NewStringObj("-clock", -1);
+	elems[1]  = Tcl_NewStringObj(Clocks[timerPtr->clock], -1);
+	elems[2]  = Tcl_NewStringObj("-overdue", -1);
+	elems[3]  = Tcl_NewStringObj(Policies[timerPtr->overdue], -1);
+	elems[4]  = Tcl_NewStringObj("-repeat", -1);
+	elems[5]  = Tcl_NewBooleanObj(timerPtr->repeat);
+	elems[6]  = Tcl_NewStringObj("interval", -1);
+	elems[7]  = Tcl_NewWideIntObj(timerPtr->interval);
+	elems[8]  = Tcl_NewStringObj("remaining", -1);
+	elems[9]  = Tcl_NewWideIntObj(remaining);
+	elems[10] = Tcl_NewStringObj("script", -1);
+	elems[11] = timerPtr->scriptObj;
+
+	return Tcl_NewListObj(12, elems);
+}
+
+/* winpm after ms ?-option value ...? script */
+static int
+CreateTimer (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *options[] = { "-clock", "-overdue", "-repeat", NULL };
+	typedef enum { OPT_CLOCK, OPT_OVERDUE, OPT_REPEAT } OPT_Option;
+	Timer *timerPtr, new;
+	char id[TCL_INTEGER_SPACE + 10];
+	int i, opt, value, isNew;
+
+	if (objc < 4 || objc % 2 != 0) {
+		Tcl_WrongNumArgs(interp, 2, objv, "ms ?-option value ...? script");
+		return TCL_ERROR;
+	}
+
+	memset(&new, 0, sizeof(new));
+	new.statePtr = statePtr;
+	new.clock = CLOCK_MONOTONIC;
+	new.overdue = OVERDUE_ONCE;
+
+	if (Tcl_GetWideIntFromObj(interp, objv[2], &new.interval) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	for (i = 3; i < objc - 1; i += 2) {
+		if (Tcl_GetIndexFromObj(interp, objv[i], options, "option",
+				0, &opt) != TCL_OK) { return TCL_ERROR; }
+		switch (opt) {
+			case OPT_CLOCK:
+				if (Tcl_GetIndexFromObj(interp, objv[i+1], Clocks, "clock",
+						0, &value) != TCL_OK) { return TCL_ERROR; }
+				new.clock = (Clock) value;
+			break;
+
+			case OPT_OVERDUE:
+				if (Tcl_GetIndexFromObj(interp, objv[i+1], Policies,
+						"policy", 0, &value) != TCL_OK) { return TCL_ERROR; }
+				new.overdue = (Overdue) value;
+			break;
+
+			case OPT_REPEAT:
+				if (Tcl_GetBooleanFromObj(interp, objv[i+1],
+						&new.repeat) != TCL_OK) { return TCL_ERROR; }
+			break;
+		}
+	}
+
+	if (new.interval < (new.repeat ? 1 : 0)) {
+		Tcl_AppendResult(interp, "bad interval \"", Tcl_GetString(objv[2]),
+				"\"", NULL);
+		return TCL_ERROR;
+	}
+
+	new.scriptObj = objv[objc-1];
+	Tcl_IncrRefCount(new.scriptObj);
+	new.deadline = Now(statePtr, new.clock) + new.interval;
+
+	timerPtr = (Timer *) ckalloc(sizeof(Timer));
+	*timerPtr = new;
+
+	sprintf(id, "winpmafter#%d", statePtr->timers.nextId++);
+	timerPtr->entryPtr = Tcl_CreateHashEntry(&statePtr->timers.table,
+			id, &isNew);
+	Tcl_SetHashValue(timerPtr->entryPtr, (ClientData) timerPtr);
+	Arm(timerPtr);
+
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(id, -1));
+	return TCL_OK;
+}
+
+/*
+ * winpm after ms ?-option value ...? script
+ * winpm after cancel id
+ * winpm after info ?id?
+ */
+int
+Winpm_CmdAfter (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *subcmds[] = { "cancel", "info", NULL };
+	typedef enum { AFT_CANCEL, AFT_INFO } AFT_Option;
+	Tcl_HashEntry *entryPtr;
+	Tcl_HashSearch search;
+	Tcl_WideInt ms;
+	int opt;
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "option ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetWideIntFromObj(NULL, objv[2], &ms) == TCL_OK) {
+		return CreateTimer(interp, statePtr, objc, objv);
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], subcmds, "option",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	if (objc == 3 && opt == AFT_INFO) {
+		Tcl_Obj *listObj;
+
+		listObj = Tcl_NewListObj(0, NULL);
+		entryPtr = Tcl_FirstHashEntry(&statePtr->timers.table, &search);
+		while (entryPtr != NULL) {
+			Tcl_ListObjAppendElement(interp, listObj, Tcl_NewStringObj(
+					Tcl_GetHashKey(&statePtr->timers.table, entryPtr), -1));
+			entryPtr = Tcl_NextHashEntry(&search);
+		}
+		Tcl_SetObjResult(interp, listObj);
+		return TCL_OK;
+	}
+
+	if (objc != 4) {
+		Tcl_WrongNumArgs(interp, 3, objv, "id");
+		return TCL_ERROR;
+	}
+
+	entryPtr = Tcl_FindHashEntry(&statePtr->timers.table,
+			Tcl_GetString(objv[3]));
+
+	switch (opt) {
+		case AFT_CANCEL:
+			/* Like [after cancel], cancelling a gone timer is fine */
+			if (entryPtr != NULL) {
+				DeleteTimer((Timer *) Tcl_GetHashValue(entryPtr));
+			}
+			return TCL_OK;
+		break;
+
+		case AFT_INFO:
+			if (entryPtr == NULL) {
+				Tcl_AppendResult(interp, "event \"", Tcl_GetString(objv[3]),
+						"\" doesn't exist", NULL);
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult(interp,
+					NewTimerInfoObj((Timer *) Tcl_GetHashValue(entryPtr)));
+			return TCL_OK;
+		break;
+	}
+
+	return TCL_OK;
+}
+
+/*
+ * Returns by how many milliseconds the system time has been moved
+ * forward (negative if back) since the last call.
+ */
+Tcl_WideInt
+Winpm_TakeClockStep (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_WideInt offset, step;
+
+	offset = Now(statePtr, CLOCK_WALL) - Now(statePtr, CLOCK_SUSPEND);
+	step = offset - statePtr->timers.offset;
+	statePtr->timers.offset = offset;
+
+	return step;
+}
+
+/*
+ * winpm _suspended ms
+ *
+ * Makes the suspend-inclusive and wall clocks jump forward by ms,
+ * as if the system has been suspended for that long.
+ */
+int
+Winpm_CmdSuspended (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Tcl_WideInt ms;
+
+	if (objc != 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "ms");
+		return TCL_ERROR;
+	}
+	if (Tcl_GetWideIntFromObj(interp, objv[2], &ms) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	statePtr->timers.skew += ms;
+	return TCL_OK;
+}
+
+/*
+ * winpm _timechange ms
+ *
+ * Moves the wall clock forward by ms (back if negative) and sends the
+ * monitoring window WM_TIMECHANGE as the system would.
+ */
+int
+Winpm_CmdTimeChange (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Tcl_WideInt ms;
+
+	if (objc != 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "ms");
+		return TCL_ERROR;
+	}
+	if (Tcl_GetWideIntFromObj(interp, objv[2], &ms) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	if (Winpm_HoldMonitor(statePtr) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	statePtr->timers.step += ms;
+	SendMessage(statePtr->hwndMonitor, WM_TIMECHANGE, 0, 0);
+	Winpm_ReleaseMonitor(statePtr);
+
+	return TCL_OK;
+}
@@ -0,0 +1,325 @@
+/*
+ * winpmAsync.c --
+ *   Asynchronous bindings.
+ *
+ *   The script bound with -async is not evaluated by the dispatcher
+ *   but launched as a coroutine, so the dispatcher gets control back
+ *   as soon as the script yields (to wait for a channel to become
+ *   readable, say), and the script is resumed later by whatever it
+ *   waits for, outside of the window procedure: a handler waiting
+ *   for I/O neither holds up the events after it nor grows the C stack.
+ *   The package is built against the stubs of Tcl 8.5, which lack the
+ *   NRE interface, so the coroutine is created with the [coroutine]
+ *   command of Tcl 8.6, which such bindings require; its body catches
+ *   the outcome of the script and reports it with [winpm _resolve].
+ *
+ *   The answer to a query can't wait for the coroutine, though, as
+ *   processing events from within the window procedure would let
+ *   window messages in, the next query included: a script which
+ *   completes without yielding answers the query itself, otherwise
+ *   the request is granted and the run is accounted as an overrun.
+ *   The coroutines still running are listed by [winpm info async].
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+#define ASYNC_NAMESPACE "::" PACKAGE_NAME
+
+/* Lambda the coroutine runs: evaluates the script at the global level
+ * and hands its completion code, result and options over to us */
+#define ASYNC_BODY "{id script} {" \
+	"::" PACKAGE_NAME " _resolve $id [catch {uplevel #0 $script} r o] $r $o}"
+
+/* Script of an asynchronous binding launched by the dispatcher */
+struct Winpm_AsyncRun {
+	Winpm_InterpData *statePtr;
+	Winpm_Binding *bindPtr; /* Preserved while the run is tracked */
+	CONST char *event;
+	long id;
+	Tcl_Obj *nameObj; /* Of the coroutine command */
+	Tcl_Time started;
+	int finished; /* Set once the script has completed */
+	int code; /* Completion code of the script */
+	int tracked; /* Set while in the list of runs */
+	Winpm_AsyncRun *nextPtr;
+};
+
+static void
+FreeRun (
+	char *blockPtr
+	)
+{
+	Winpm_AsyncRun *runPtr = (Winpm_AsyncRun *) blockPtr;
+
+	Tcl_DecrRefCount(runPtr->nameObj);
+	Tcl_Release((ClientData) runPtr->bindPtr);
+	ckfree((char *) runPtr);
+}
+
+static void
+UnlinkRun (
+	Winpm_AsyncRun *runPtr
+	)
+{
+	Winpm_AsyncRun **linkPtr;
+
+	if (!runPtr->tracked) return;
+	for (linkPtr = &runPtr->statePtr->async.head; *linkPtr != runPtr;
+			linkPtr = &(*linkPtr)->nextPtr) {}
+	*linkPtr = runPtr->nextPtr;
+	runPtr->tracked = 0;
+}
+
+/* Called when the coroutine command goes away, normally on return */
+static void
+CoroutineDeleted (
+	ClientData clientData,
+	Tcl_Interp *interp,
+	CONST char *oldName,
+	CONST char *newName,
+	int flags
+	)
+{
+	Winpm_AsyncRun *runPtr = (Winpm_AsyncRun *) clientData;
+
+	UnlinkRun(runPtr);
+	Tcl_EventuallyFree((ClientData) runPtr, FreeRun);
+}
+
+void
+Winpm_InitAsync (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->async.head = NULL;
+	statePtr->async.nextId = 1;
+}
+
+/* Stops tracking the coroutines still running and deletes them */
+void
+Winpm_FinalizeAsync (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_Interp *interp = statePtr->interp;
+	Winpm_AsyncRun *runPtr;
+
+	while (statePtr->async.head != NULL) {
+		runPtr = statePtr->async.head;
+		UnlinkRun(runPtr);
+		Tcl_UntraceCommand(interp, Tcl_GetString(runPtr->nameObj),
+				TCL_TRACE_DELETE, CoroutineDeleted, (ClientData) runPtr);
+		if (!Tcl_InterpDeleted(interp)) {
+			Tcl_DeleteCommand(interp, Tcl_GetString(runPtr->nameObj));
+		}
+		Tcl_EventuallyFree((ClientData) runPtr, FreeRun);
+	}
+}
+
+/* Tells whether the interpreter has coroutines, i.e. -async can be used */
+int
+Winpm_HasCoroutines (
+	Tcl_Interp *interp
+	)
+{
+	Tcl_CmdInfo info;
+
+	return Tcl_GetCommandInfo(interp, "::coroutine", &info);
+}
+
+/*
+ * Launches the script of the asynchronous binding as a coroutine.
+ * Returns TCL_OK once the script yields or completes unless wait is
+ * set (the event is a query); then returns the completion code of the
+ * script if it completes without yielding, TCL_OK otherwise.
+ */
+int
+Winpm_RunAsync (
+	Winpm_InterpData *statePtr,
+	Winpm_Binding *bindPtr,
+	Tcl_Obj *scriptObj,
+	CONST char *event,
+	int wait
+	)
+{
+	Tcl_Interp *interp = statePtr->interp;
+	Winpm_AsyncRun *runPtr;
+	Tcl_Obj *objv[6];
+	Tcl_CmdInfo info;
+	int i, code;
+
+	++bindPtr->stats.calls;
+
+	runPtr = (Winpm_AsyncRun *) ckalloc(sizeof(Winpm_AsyncRun));
+	runPtr->statePtr = statePtr;
+	runPtr->bindPtr = bindPtr;
+	Tcl_Preserve((ClientData) bindPtr);
+	runPtr->event = event;
+	runPtr->id = statePtr->async.nextId++;
+	runPtr->nameObj = Tcl_ObjPrintf(ASYNC_NAMESPACE "::async%ld",
+			runPtr->id);
+	Tcl_IncrRefCount(runPtr->nameObj);
+	Tcl_GetTime(&runPtr->started);
+	runPtr->finished = 0;
+	runPtr->code = TCL_OK;
+
+	/* [winpm _resolve] finds the run in the list */
+	runPtr->tracked = 1;
+	runPtr->nextPtr = statePtr->async.head;
+	statePtr->async.head = runPtr;
+
+	if (Tcl_FindNamespace(interp, ASYNC_NAMESPACE, NULL, 0) == NULL) {
+		Tcl_CreateNamespace(interp, ASYNC_NAMESPACE, NULL, NULL);
+	}
+
+	objv[0] = Tcl_NewStringObj("::coroutine", -1);
+	objv[1] = runPtr->nameObj;
+	objv[2] = Tcl_NewStringObj("::apply", -1);
+	objv[3] = Tcl_NewStringObj(ASYNC_BODY, -1);
+	objv[4] = Tcl_NewLongObj(runPtr->id);
+	objv[5] = scriptObj;
+	for (i = 0; i < 6; ++i) {
+		Tcl_IncrRefCount(objv[i]);
+	}
+
+	Tcl_Preserve((ClientData) runPtr);
+	code = Tcl_EvalObjv(interp, 6, objv, TCL_EVAL_GLOBAL);
+	for (i = 0; i < 6; ++i) {
+		Tcl_DecrRefCount(objv[i]);
+	}
+
+	if (code == TCL_ERROR) {
+		/* The coroutine couldn't be created, the script never ran */
+		++bindPtr->stats.errors;
+		Tcl_AddErrorInfo(interp, "\n    (launching command bound to ");
+		Tcl_AddErrorInfo(interp, event);
+		Tcl_AddErrorInfo(interp, " " PACKAGE_NAME " event)");
+		Winpm_ReportError(statePtr, bindPtr, event);
+	} else {
+		/* Whatever the script yielded is of no interest */
+		Tcl_ResetResult(interp);
+	}
+
+	if (Tcl_GetCommandInfo(interp, Tcl_GetString(runPtr->nameObj), &info)) {
+		Tcl_TraceCommand(interp, Tcl_GetString(runPtr->nameObj),
+				TCL_TRACE_DELETE, CoroutineDeleted, (ClientData) runPtr);
+	} else {
+		UnlinkRun(runPtr);
+		Tcl_EventuallyFree((ClientData) runPtr, FreeRun);
+	}
+
+	code = TCL_OK;
+	if (wait && runPtr->finished) {
+		code = runPtr->code;
+	} else if (wait) {
+		/* The request is granted, the script goes on */
+		++bindPtr->stats.overruns;
+	}
+
+	Tcl_Release((ClientData) runPtr);
+	return code;
+}
+
+/*
+ * winpm _resolve id code result options
+ *
+ * Called by the coroutine of an asynchronous binding with the outcome
+ * of its script: accounts the run and reports errors.
+ */
+int
+Winpm_CmdResolve (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Winpm_AsyncRun *runPtr;
+	Winpm_Binding *bindPtr;
+	long id;
+	int code;
+
+	if (objc != 6) {
+		Tcl_WrongNumArgs(interp, 2, objv, "id code result options");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetLongFromObj(interp, objv[2], &id) != TCL_OK
+			|| Tcl_GetIntFromObj(interp, objv[3], &code) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	for (runPtr = statePtr->async.head; runPtr; runPtr = runPtr->nextPtr) {
+		if (runPtr->id == id) break;
+	}
+	if (runPtr == NULL || runPtr->finished) {
+		Tcl_AppendResult(interp, "no asynchronous run \"",
+				Tcl_GetString(objv[2]), "\"", NULL);
+		return TCL_ERROR;
+	}
+
+	runPtr->finished = 1;
+	runPtr->code = code;
+	bindPtr = runPtr->bindPtr;
+
+	if (code == TCL_ERROR) {
+		++bindPtr->stats.errors;
+		Tcl_SetObjResult(interp, objv[4]);
+		Tcl_SetReturnOptions(interp, objv[5]);
+		Tcl_AddErrorInfo(interp, "\n    (command bound to ");
+		Tcl_AddErrorInfo(interp, runPtr->event);
+		Tcl_AddErrorInfo(interp, " " PACKAGE_NAME " event)");
+		Winpm_ReportError(statePtr, bindPtr, runPtr->event);
+	} else {
+		bindPtr->failures.consecutive = 0;
+	}
+
+	Tcl_ResetResult(interp);
+	return TCL_OK;
+}
+
+/*
+ * Returns the description of the coroutines still running for
+ * [winpm info async]: a list of dictionaries with the id of the run,
+ * the event, the name of the coroutine and the milliseconds elapsed
+ * since the launch.
+ */
+Tcl_Obj *
+Winpm_NewAsyncInfoObj (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_AsyncRun *runPtr;
+	Tcl_Obj *listObj, *runObj, *elems[8];
+	Tcl_Time now;
+	long elapsed;
+
+	Tcl_GetTime(&now);
+
+	/* Oldest first */
+	listObj = Tcl_NewListObj(0, NULL);
+	for (runPtr = statePtr->async.head; runPtr; runPtr = runPtr->nextPtr) {
+		elapsed = (now.sec - runPtr->started.sec) * 1000
+			+ (now.usec - runPtr->started.usec) / 1000;
+
+		elems[0] = Tcl_NewStringObj("id", -1);
+		elems[1] = Tcl_NewLongObj(runPtr->id);
+		elems[2] = Tcl_NewStringObj("event", -1);
+		elems[3] = Tcl_NewStringObj(runPtr->event, -1);
+		elems[4] = Tcl_NewStringObj("coroutine", -1);
+		elems[5] = runPtr->nameObj;
+		elems[6] = Tcl_NewStringObj("elapsed", -1);
+		elems[7] = Tcl_NewLongObj(elapsed);
+		runObj = Tcl_NewListObj(8, elems);
+		Tcl_ListObjReplace(NULL, listObj, 0, 0, 1, &runObj);
+	}
+
+	return listObj;
+}
@@ -0,0 +1,1023 @@
+/*
+ * winpmBroker.c --
+ *   Relaying power notifications between processes.
+ *
+ *   Each process loading the package has its own monitoring window
+ *   and handles every power broadcast itself. An interpreter can serve
+ *   as a broker instead: it keeps watching the broadcasts and streams
+ *   them to any number of clients over a named pipe, and the clients
+ *   replay them through the same dispatching code as if their own
+ *   window got them, ignoring those broadcasts when their windows get
+ *   them. Queries are not relayed: each process answers its own. Nor
+ *   are the power setting changes (PBT_POWERSETTINGCHANGE and the lid
+ *   and power source events): the window of each client registers for
+ *   the settings itself.
+ *
+ *   Events are sent as frames of 32-bit words: the length of the frame
+ *   in bytes, the WINPM_* type and the fields of the event specific to
+ *   that type. The first frame a client gets is a greeting of type 0
+ *   carrying BROKER_MAGIC and BROKER_VERSION.
+ *
+ *   The broker never waits for its clients: each client has a bounded
+ *   queue of frames written out by a thread of its own, which sends
+ *   whatever has piled up since its last write in one go; when a slow
+ *   client's queue is full the new frames are dropped for it and
+ *   counted. The connections are accepted by one more thread, and a
+ *   client reads the frames on a thread which passes them to the
+ *   thread of its interpreter through the Tcl event queue. When the
+ *   pipe breaks the reader queues an event of type 0 instead, and the
+ *   client falls back to its own window.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+#define BROKER_MAGIC   0x4D505742 /* "BWPM" */
+#define BROKER_VERSION 2
+
+#define BROKER_QUEUE   4096 /* Bytes of frames a client may lag behind */
+#define BROKER_FRAME   64 /* Max length of a frame, bytes */
+#define BROKER_TIMEOUT 5000 /* Time to wait for the broker, ms */
+
+/* Events relayed; queries, settings, session and sampled events are
+ * handled locally */
+#define BROKER_EVENTS (WINPM_POWERSTATUSCHANGE | WINPM_RESUMEAUTOMATIC \
+		| WINPM_RESUMESUSPEND | WINPM_SUSPEND | WINPM_BATTERYLOW \
+		| WINPM_OEMEVENT | WINPM_QUERYSUSPENDFAILED \
+		| WINPM_RESUMECRITICAL)
+
+typedef struct BrokerClient BrokerClient;
+
+struct BrokerClient {
+	Winpm_Broker *brokerPtr;
+	HANDLE pipe;
+	HANDLE wakeup; /* Set when frames are queued */
+	char frames[BROKER_QUEUE]; /* Queued, not yet written */
+	int used; /* Bytes in frames */
+	long dropped; /* Frames not queued for lack of room */
+	int started; /* Set if the writer thread was created */
+	int dead; /* Set when the writer thread exits */
+	Tcl_ThreadId writer;
+	BrokerClient *nextPtr;
+};
+
+struct Winpm_Broker {
+	Winpm_InterpData *statePtr;
+	Tcl_Obj *nameObj;
+	Tcl_DString native; /* Name of the pipe in the system encoding */
+	HANDLE stop; /* Set to stop all the threads */
+	HANDLE listening; /* First pipe instance, taken by the acceptor */
+	Tcl_ThreadId acceptor;
+	Tcl_Mutex mutex; /* Protects the list of clients and their queues */
+	BrokerClient *clients;
+	long frames; /* Events relayed */
+	long dropped; /* Frames dropped for the clients gone */
+};
+
+struct Winpm_Connection {
+	Winpm_InterpData *statePtr;
+	Tcl_ThreadId owner; /* Thread of the interpreter */
+	Tcl_Obj *nameObj;
+	HANDLE pipe;
+	HANDLE stop; /* Set to stop the reader thread */
+	Tcl_ThreadId reader;
+	long received; /* Events replayed */
+};
+
+/* Event a client's reader queues for the thread of its interpreter;
+ * type 0 means the connection is lost */
+typedef struct {
+	Tcl_Event header;
+	Winpm_InterpData *statePtr;
+	Winpm_Event event;
+} BrokerEvent;
+
+/*
+ * Frames
+ */
+
+/* Puts the frame into buf, which must hold BROKER_FRAME bytes;
+ * returns its length */
+static int
+PutFrame (
+	char *buf,
+	int type,
+	CONST LONG *values,
+	int count
+	)
+{
+	DWORD header[2];
+
+	header[0] = (DWORD) (sizeof(header) + count * sizeof(LONG));
+	header[1] = (DWORD) type;
+	memcpy(buf, header, sizeof(header));
+	memcpy(buf + sizeof(header), values, count * sizeof(LONG));
+
+	return (int) header[0];
+}
+
+static int
+EncodeEvent (
+	CONST Winpm_Event *eventPtr,
+	char *buf
+	)
+{
+	LONG values[5];
+	int count = 0;
+
+	switch (eventPtr->type) {
+		case WINPM_POWERSTATUSCHANGE:
+			values[0] = eventPtr->power.changed;
+			values[1] = eventPtr->power.acLine;
+			values[2] = eventPtr->power.batteryFlag;
+			values[3] = eventPtr->power.batteryPercent;
+			values[4] = eventPtr->power.batteryLifeTime;
+			count = 5;
+		break;
+
+		case WINPM_OEMEVENT:
+			values[0] = eventPtr->oemCode;
+			count = 1;
+		break;
+	}
+
+	return PutFrame(buf, eventPtr->type, values, count);
+}
+
+/*
+ * Fills the event from the frame. Returns 0 if the frame is not an
+ * event or is too short for its type; extra values are ignored so
+ * that later versions may add fields.
+ */
+static int
+DecodeEvent (
+	CONST char *buf,
+	DWORD length,
+	Winpm_Event *eventPtr
+	)
+{
+	DWORD header[2];
+	LONG values[5];
+	int count, needed;
+
+	memcpy(header, buf, sizeof(header));
+	count = (int) ((length - sizeof(header)) / sizeof(LONG));
+	if (count > 5) count = 5;
+	memcpy(values, buf + sizeof(header), count * sizeof(LONG));
+
+	memset(eventPtr, 0, sizeof(*eventPtr));
+	eventPtr->type = (int) header[1];
+	eventPtr->power.changed = -1;
+
+	if ((eventPtr->type & BROKER_EVENTS) == 0) return 0;
+
+	switch (eventPtr->type) {
+		case WINPM_POWERSTATUSCHANGE: needed = 5; break;
+		case WINPM_OEMEVENT:          needed = 1; break;
+		default:                      needed = 0; break;
+	}
+	if (count < needed) return 0;
+
+	switch (eventPtr->type) {
+		case WINPM_POWERSTATUSCHANGE:
+			eventPtr->power.changed = (int) values[0];
+			eventPtr->power.acLine = (int) values[1];
+			eventPtr->power.batteryFlag = (int) values[2];
+			eventPtr->power.batteryPercent = (int) values[3];
+			eventPtr->power.batteryLifeTime = (long) values[4];
+		break;
+
+		case WINPM_OEMEVENT:
+			eventPtr->oemCode = (long) values[0];
+		break;
+	}
+
+	return 1;
+}
+
+/*
+ * Reads or writes the pipe until done, the stop event is set or the
+ * timeout (ms) expires. Returns 0 on failure or if nothing could be
+ * transferred. ovPtr must have a manual-reset event.
+ */
+static int
+Transfer (
+	HANDLE pipe,
+	OVERLAPPED *ovPtr,
+	HANDLE stop,
+	int write,
+	char *buf,
+	DWORD size,
+	DWORD timeout,
+	DWORD *donePtr
+	)
+{
+	HANDLE waits[2];
+	BOOL ok;
+
+	ResetEvent(ovPtr->hEvent);
+	if (write) {
+		ok = WriteFile(pipe, buf, size, NULL, ovPtr);
+	} else {
+		ok = ReadFile(pipe, buf, size, NULL, ovPtr);
+	}
+	if (!ok && GetLastError() != ERROR_IO_PENDING) return 0;
+
+	waits[0] = stop;
+	waits[1] = ovPtr->hEvent;
+	if (WaitForMultipleObjects(2, waits, FALSE, timeout)
+			!= WAIT_OBJECT_0 + 1) {
+		/* The system owns the structure until the request ends */
+		CancelIo(pipe);
+		GetOverlappedResult(pipe, ovPtr, donePtr, TRUE);
+		return 0;
+	}
+
+	return GetOverlappedResult(pipe, ovPtr, donePtr, FALSE) && *donePtr > 0;
+}
+
+/*
+ * Broker
+ */
+
+static HANDLE
+NewInstance (
+	Winpm_Broker *brokerPtr
+	)
+{
+	return CreateNamedPipe((LPCTSTR) Tcl_DStringValue(&brokerPtr->native),
+			PIPE_ACCESS_OUTBOUND | FILE_FLAG_OVERLAPPED,
+			PIPE_TYPE_BYTE | PIPE_WAIT, PIPE_UNLIMITED_INSTANCES,
+			BROKER_QUEUE, 0, 0, NULL);
+}
+
+static Tcl_ThreadCreateType
+Writer (
+	ClientData clientData
+	)
+{
+	BrokerClient *clientPtr = (BrokerClient *) clientData;
+	Winpm_Broker *brokerPtr = clientPtr->brokerPtr;
+	char batch[BROKER_QUEUE];
+	HANDLE waits[2];
+	OVERLAPPED ov;
+	DWORD size, written;
+	int ok = 1;
+
+	memset(&ov, 0, sizeof(ov));
+	ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	waits[0] = brokerPtr->stop;
+	waits[1] = clientPtr->wakeup;
+
+	while (ok && WaitForMultipleObjects(2, waits, FALSE, INFINITE)
+			== WAIT_OBJECT_0 + 1) {
+		/* Everything queued since the last write goes out at once */
+		Tcl_MutexLock(&brokerPtr->mutex);
+		size = (DWORD) clientPtr->used;
+		memcpy(batch, clientPtr->frames, size);
+		clientPtr->used = 0;
+		Tcl_MutexUnlock(&brokerPtr->mutex);
+
+		if (size > 0) {
+			ok = Transfer(clientPtr->pipe, &ov, brokerPtr->stop, 1,
+					batch, size, INFINITE, &written) && written == size;
+		}
+	}
+
+	CloseHandle(ov.hEvent);
+
+	Tcl_MutexLock(&brokerPtr->mutex);
+	clientPtr->dead = 1;
+	Tcl_MutexUnlock(&brokerPtr->mutex);
+
+	TCL_THREAD_CREATE_RETURN;
+}
+
+/* Starts serving the connected pipe instance */
+static void
+AddClient (
+	Winpm_Broker *brokerPtr,
+	HANDLE pipe
+	)
+{
+	BrokerClient *clientPtr;
+	LONG greeting[2];
+
+	clientPtr = (BrokerClient *) ckalloc(sizeof(BrokerClient));
+	memset(clientPtr, 0, sizeof(BrokerClient));
+	clientPtr->brokerPtr = brokerPtr;
+	clientPtr->pipe = pipe;
+	clientPtr->wakeup = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+	greeting[0] = BROKER_MAGIC;
+	greeting[1] = BROKER_VERSION;
+	clientPtr->used = PutFrame(clientPtr->frames, 0, greeting, 2);
+
+	/* The client gets the greeting only once it's in the list,
+	 * so no event fired after it's connected is missed */
+	Tcl_MutexLock(&brokerPtr->mutex);
+	clientPtr->nextPtr = brokerPtr->clients;
+	brokerPtr->clients = clientPtr;
+	if (Tcl_CreateThread(&clientPtr->writer, Writer, (ClientData) clientPtr,
+			TCL_THREAD_STACK_DEFAULT, TCL_THREAD_JOINABLE) == TCL_OK) {
+		clientPtr->started = 1;
+		SetEvent(clientPtr->wakeup);
+	} else {
+		clientPtr->dead = 1;
+	}
+	Tcl_MutexUnlock(&brokerPtr->mutex);
+}
+
+/* Waits for a client to connect to the pipe instance */
+static int
+WaitForClient (
+	Winpm_Broker *brokerPtr,
+	HANDLE pipe,
+	OVERLAPPED *ovPtr
+	)
+{
+	HANDLE waits[2];
+	DWORD dummy;
+
+	ResetEvent(ovPtr->hEvent);
+	if (ConnectNamedPipe(pipe, ovPtr)) return 1;
+
+	switch (GetLastError()) {
+		case ERROR_PIPE_CONNECTED:
+			return 1;
+		break;
+
+		case ERROR_IO_PENDING:
+			waits[0] = brokerPtr->stop;
+			waits[1] = ovPtr->hEvent;
+			if (WaitForMultipleObjects(2, waits, FALSE, INFINITE)
+					== WAIT_OBJECT_0 + 1) {
+				return GetOverlappedResult(pipe, ovPtr, &dummy, FALSE);
+			}
+			CancelIo(pipe);
+			GetOverlappedResult(pipe, ovPtr, &dummy, TRUE);
+			return 0;
+		break;
+	}
+
+	return 0;
+}
+
+static Tcl_ThreadCreateType
+Acceptor (
+	ClientData clientData
+	)
+{
+	Winpm_Broker *brokerPtr = (Winpm_Broker *) clientData;
+	HANDLE pipe, next;
+	OVERLAPPED ov;
+
+	memset(&ov, 0, sizeof(ov));
+	ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+	pipe = brokerPtr->listening;
+	while (WaitForClient(brokerPtr, pipe, &ov)) {
+		/* Be ready for the next client before serving this one */
+		next = NewInstance(brokerPtr);
+		AddClient(brokerPtr, pipe);
+		pipe = next;
+		if (pipe == INVALID_HANDLE_VALUE) break;
+	}
+	if (pipe != INVALID_HANDLE_VALUE) {
+		CloseHandle(pipe);
+	}
+
+	CloseHandle(ov.hEvent);
+	TCL_THREAD_CREATE_RETURN;
+}
+
+static void
+FreeClient (
+	BrokerClient *clientPtr
+	)
+{
+	int result;
+
+	if (clientPtr->started) {
+		Tcl_JoinThread(clientPtr->writer, &result);
+	}
+	CloseHandle(clientPtr->pipe);
+	CloseHandle(clientPtr->wakeup);
+	clientPtr->brokerPtr->dropped += clientPtr->dropped;
+	ckfree((char *) clientPtr);
+}
+
+/* Frees the clients whose writers have exited */
+static void
+ReapClients (
+	Winpm_Broker *brokerPtr
+	)
+{
+	BrokerClient **linkPtr, *clientPtr, *deadPtr = NULL;
+
+	Tcl_MutexLock(&brokerPtr->mutex);
+	linkPtr = &brokerPtr->clients;
+	while (*linkPtr != NULL) {
+		clientPtr = *linkPtr;
+		if (clientPtr->dead) {
+			*linkPtr = clientPtr->nextPtr;
+			clientPtr->nextPtr = deadPtr;
+			deadPtr = clientPtr;
+		} else {
+			linkPtr = &clientPtr->nextPtr;
+		}
+	}
+	Tcl_MutexUnlock(&brokerPtr->mutex);
+
+	while (deadPtr != NULL) {
+		clientPtr = deadPtr;
+		deadPtr = deadPtr->nextPtr;
+		FreeClient(clientPtr);
+	}
+}
+
+/* Subscriber queueing the events for all the clients */
+static int
+Relay (
+	ClientData clientData,
+	CONST Winpm_Event *eventPtr
+	)
+{
+	Winpm_Broker *brokerPtr = (Winpm_Broker *) clientData;
+	BrokerClient *clientPtr;
+	char frame[BROKER_FRAME];
+	int length;
+
+	ReapClients(brokerPtr);
+
+	length = EncodeEvent(eventPtr, frame);
+
+	Tcl_MutexLock(&brokerPtr->mutex);
+	for (clientPtr = brokerPtr->clients; clientPtr;
+			clientPtr = clientPtr->nextPtr) {
+		if (clientPtr->used + length > BROKER_QUEUE) {
+			++clientPtr->dropped;
+		} else {
+			memcpy(clientPtr->frames + clientPtr->used, frame, length);
+			clientPtr->used += length;
+			SetEvent(clientPtr->wakeup);
+		}
+	}
+	++brokerPtr->frames;
+	Tcl_MutexUnlock(&brokerPtr->mutex);
+
+	return TCL_OK;
+}
+
+static void
+StopBroker (
+	Winpm_Broker *brokerPtr
+	)
+{
+	Winpm_InterpData *statePtr = brokerPtr->statePtr;
+	BrokerClient *clientPtr;
+	int result;
+
+	SetEvent(brokerPtr->stop);
+	Tcl_JoinThread(brokerPtr->acceptor, &result);
+
+	/* No one else touches the list now */
+	while (brokerPtr->clients != NULL) {
+		clientPtr = brokerPtr->clients;
+		brokerPtr->clients = clientPtr->nextPtr;
+		FreeClient(clientPtr);
+	}
+
+	Winpm_Unsubscribe(statePtr->interp, BROKER_EVENTS,
+			Relay, (ClientData) brokerPtr);
+
+	CloseHandle(brokerPtr->stop);
+	Tcl_MutexFinalize(&brokerPtr->mutex);
+	Tcl_DStringFree(&brokerPtr->native);
+	Tcl_DecrRefCount(brokerPtr->nameObj);
+	ckfree((char *) brokerPtr);
+}
+
+static int
+StartBroker (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	Tcl_Obj *nameObj
+	)
+{
+	Winpm_Broker *brokerPtr;
+	DWORD error;
+
+	brokerPtr = (Winpm_Broker *) ckalloc(sizeof(Winpm_Broker));
+	memset(brokerPtr, 0, sizeof(Winpm_Broker));
+	brokerPtr->statePtr = statePtr;
+	Tcl_DStringInit(&brokerPtr->native);
+	Tcl_WinUtfToTChar(Tcl_GetString(nameObj), -1, &brokerPtr->native);
+
+	/* The first instance is created here to report a bad name */
+	brokerPtr->listening = NewInstance(brokerPtr);
+	if (brokerPtr->listening == INVALID_HANDLE_VALUE) {
+		error = GetLastError();
+		Tcl_DStringFree(&brokerPtr->native);
+		ckfree((char *) brokerPtr);
+		Tcl_AppendResult(interp, "couldn't serve \"",
+				Tcl_GetString(nameObj), "\": ", NULL);
+		Winpm_AppendSystemError(interp, error);
+		return TCL_ERROR;
+	}
+
+	if (Winpm_Subscribe(interp, BROKER_EVENTS,
+			Relay, (ClientData) brokerPtr) != TCL_OK) {
+		CloseHandle(brokerPtr->listening);
+		Tcl_DStringFree(&brokerPtr->native);
+		ckfree((char *) brokerPtr);
+		return TCL_ERROR;
+	}
+
+	brokerPtr->stop = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (Tcl_CreateThread(&brokerPtr->acceptor, Acceptor,
+			(ClientData) brokerPtr, TCL_THREAD_STACK_DEFAULT,
+			TCL_THREAD_JOINABLE) != TCL_OK) {
+		Winpm_Unsubscribe(interp, BROKER_EVENTS,
+				Relay, (ClientData) brokerPtr);
+		CloseHandle(brokerPtr->stop);
+		CloseHandle(brokerPtr->listening);
+		Tcl_DStringFree(&brokerPtr->native);
+		ckfree((char *) brokerPtr);
+		Tcl_SetResult(interp, "couldn't create thread", TCL_STATIC);
+		return TCL_ERROR;
+	}
+
+	brokerPtr->nameObj = nameObj;
+	Tcl_IncrRefCount(nameObj);
+
+	if (statePtr->broker.serverPtr != NULL) {
+		StopBroker(statePtr->broker.serverPtr);
+	}
+	statePtr->broker.serverPtr = brokerPtr;
+
+	return TCL_OK;
+}
+
+/*
+ * Client
+ */
+
+/* Runs the scripts as if the monitoring window got the broadcast */
+static void
+ReplayEvent (
+	Winpm_InterpData *statePtr,
+	CONST Winpm_Event *eventPtr
+	)
+{
+	Winpm_PercentMap map[6], *mapPtr;
+	char percent[TCL_INTEGER_SPACE], lifetime[TCL_INTEGER_SPACE];
+	Tcl_Obj *changedObj;
+	Winpm_EventType *classPtr;
+	SYSTEM_POWER_STATUS status;
+
+	/* Only the classes of WM_POWERBROADCAST are relayed */
+	classPtr = Winpm_FindEventType(eventPtr->type);
+	if (classPtr == NULL || classPtr->uMsg != WM_POWERBROADCAST) return;
+
+	mapPtr = NULL;
+	changedObj = NULL;
+
+	if (eventPtr->type == WINPM_POWERSTATUSCHANGE
+			&& eventPtr->power.changed != -1) {
+		/* The window of a client doesn't keep the snapshot, so the
+		 * jobs and channels follow the status of the broker */
+		status = statePtr->power.snapshot;
+		status.ACLineStatus = (BYTE) eventPtr->power.acLine;
+		status.BatteryFlag = (BYTE) eventPtr->power.batteryFlag;
+		status.BatteryLifePercent = (BYTE) (eventPtr->power.batteryPercent
+				== -1 ? 255 : eventPtr->power.batteryPercent);
+		status.BatteryLifeTime = (DWORD) eventPtr->power.batteryLifeTime;
+		if (Winpm_SetPowerSnapshot(statePtr, &status) > 0) {
+			Winpm_RescheduleJobs(statePtr);
+			Winpm_UpdateBatches(statePtr);
+			Winpm_PublishPower(statePtr);
+			Winpm_RecordPower(statePtr);
+		}
+
+		sprintf(percent, "%d", eventPtr->power.batteryPercent);
+		sprintf(lifetime, "%ld", eventPtr->power.batteryLifeTime);
+		changedObj = Winpm_NewPowerFieldsObj(eventPtr->power.changed);
+		Tcl_IncrRefCount(changedObj);
+
+		map[0].token = 'a';
+		map[0].value = Winpm_ACLineStatusName(
+				(BYTE) eventPtr->power.acLine);
+		map[1].token = 'b';
+		map[1].value = Winpm_BatteryFlagName(
+				(BYTE) eventPtr->power.batteryFlag);
+		map[2].token = 'p';
+		map[2].value = percent;
+		map[3].token = 'l';
+		map[3].value = lifetime;
+		map[4].token = 'c';
+		map[4].value = Tcl_GetString(changedObj);
+		map[5].token = '\0';
+		mapPtr = map;
+	}
+
+	if (classPtr->flags & WINPM_EVENT_RESUME) {
+		Winpm_ResumeTimers(statePtr);
+	}
+
+	Winpm_NotifySubscribers(statePtr, eventPtr);
+	Winpm_DispatchPowerBcast(statePtr, mapPtr, eventPtr->power.changed,
+			classPtr);
+
+	if (changedObj != NULL) {
+		Tcl_DecrRefCount(changedObj);
+	}
+}
+
+static void Disconnect (Winpm_Connection *connPtr);
+
+/*
+ * Called when the broker has gone away or the pipe has broken: the
+ * monitoring window handles the broadcasts again, and the loss is
+ * reported as a background error.
+ */
+static void
+LoseBroker (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_Connection *connPtr = statePtr->broker.connPtr;
+	Tcl_Interp *interp = statePtr->interp;
+	Tcl_InterpState saved;
+
+	if (connPtr == NULL) return;
+	statePtr->broker.connPtr = NULL;
+
+	saved = Tcl_SaveInterpState(interp, TCL_OK);
+	Tcl_ResetResult(interp);
+	Tcl_AppendResult(interp, "lost connection to broker \"",
+			Tcl_GetString(connPtr->nameObj), "\"", NULL);
+	Disconnect(connPtr);
+	Tcl_BackgroundError(interp);
+	Tcl_RestoreInterpState(interp, saved);
+}
+
+static int
+ProcessBrokerEvent (
+	Tcl_Event *evPtr,
+	int flags
+	)
+{
+	BrokerEvent *brokerEvPtr = (BrokerEvent *) evPtr;
+	Winpm_InterpData *statePtr = brokerEvPtr->statePtr;
+
+	if (!(flags & TCL_WINDOW_EVENTS)) return 0;
+
+	if (brokerEvPtr->event.type == 0) {
+		/* Deletes this very event along with the rest of the queued ones */
+		LoseBroker(statePtr);
+		return 1;
+	}
+
+	if (statePtr->broker.connPtr != NULL) {
+		++statePtr->broker.connPtr->received;
+	}
+	ReplayEvent(statePtr, &brokerEvPtr->event);
+	return 1;
+}
+
+/* Matches the events queued for the interpreter */
+static int
+IsBrokerEvent (
+	Tcl_Event *evPtr,
+	ClientData clientData
+	)
+{
+	return evPtr->proc == ProcessBrokerEvent
+		&& ((BrokerEvent *) evPtr)->statePtr
+			== (Winpm_InterpData *) clientData;
+}
+
+static Tcl_ThreadCreateType
+Reader (
+	ClientData clientData
+	)
+{
+	Winpm_Connection *connPtr = (Winpm_Connection *) clientData;
+	char buffer[BROKER_QUEUE];
+	BrokerEvent *evPtr;
+	OVERLAPPED ov;
+	DWORD have, got, length;
+
+	memset(&ov, 0, sizeof(ov));
+	ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+	have = 0;
+	while (Transfer(connPtr->pipe, &ov, connPtr->stop, 0, buffer + have,
+			sizeof(buffer) - have, INFINITE, &got)) {
+		have += got;
+		while (have >= 2 * sizeof(DWORD)) {
+			memcpy(&length, buffer, sizeof(DWORD));
+			if (length < 2 * sizeof(DWORD) || length > BROKER_FRAME) {
+				goto done; /* Not our protocol */
+			}
+			if (have < length) break;
+
+			evPtr = (BrokerEvent *) ckalloc(sizeof(BrokerEvent));
+			if (DecodeEvent(buffer, length, &evPtr->event)) {
+				evPtr->header.proc = ProcessBrokerEvent;
+				evPtr->statePtr = connPtr->statePtr;
+				Tcl_ThreadQueueEvent(connPtr->owner,
+						(Tcl_Event *) evPtr, TCL_QUEUE_TAIL);
+				Tcl_ThreadAlert(connPtr->owner);
+			} else {
+				ckfree((char *) evPtr);
+			}
+
+			have -= length;
+			memmove(buffer, buffer + length, have);
+		}
+	}
+
+done:
+	CloseHandle(ov.hEvent);
+
+	/* Unless told to stop, the broker is gone or talks nonsense */
+	if (WaitForSingleObject(connPtr->stop, 0) != WAIT_OBJECT_0) {
+		evPtr = (BrokerEvent *) ckalloc(sizeof(BrokerEvent));
+		memset(&evPtr->event, 0, sizeof(evPtr->event));
+		evPtr->header.proc = ProcessBrokerEvent;
+		evPtr->statePtr = connPtr->statePtr;
+		Tcl_ThreadQueueEvent(connPtr->owner,
+				(Tcl_Event *) evPtr, TCL_QUEUE_TAIL);
+		Tcl_ThreadAlert(connPtr->owner);
+	}
+
+	TCL_THREAD_CREATE_RETURN;
+}
+
+static void
+Disconnect (
+	Winpm_Connection *connPtr
+	)
+{
+	int result;
+
+	SetEvent(connPtr->stop);
+	Tcl_JoinThread(connPtr->reader, &result);
+	Tcl_DeleteEvents(IsBrokerEvent, (ClientData) connPtr->statePtr);
+
+	CloseHandle(connPtr->pipe);
+	CloseHandle(connPtr->stop);
+	Tcl_DecrRefCount(connPtr->nameObj);
+	ckfree((char *) connPtr);
+}
+
+/* Opens the pipe and checks the greeting of the broker */
+static HANDLE
+OpenBroker (
+	Tcl_Interp *interp,
+	Tcl_Obj *nameObj,
+	HANDLE stop
+	)
+{
+	Tcl_DString native;
+	LPCTSTR name;
+	HANDLE pipe;
+	OVERLAPPED ov;
+	LONG greeting[4];
+	DWORD have, got, error;
+
+	Tcl_DStringInit(&native);
+	name = (LPCTSTR) Tcl_WinUtfToTChar(Tcl_GetString(nameObj), -1, &native);
+
+	pipe = CreateFile(name, GENERIC_READ, 0, NULL, OPEN_EXISTING,
+			FILE_FLAG_OVERLAPPED, NULL);
+	if (pipe == INVALID_HANDLE_VALUE && GetLastError() == ERROR_PIPE_BUSY
+			&& WaitNamedPipe(name, BROKER_TIMEOUT)) {
+		pipe = CreateFile(name, GENERIC_READ, 0, NULL, OPEN_EXISTING,
+				FILE_FLAG_OVERLAPPED, NULL);
+	}
+	error = GetLastError();
+	Tcl_DStringFree(&native);
+
+	if (pipe == INVALID_HANDLE_VALUE) {
+		Tcl_AppendResult(interp, "couldn't connect to \"",
+				Tcl_GetString(nameObj), "\": ", NULL);
+		Winpm_AppendSystemError(interp, error);
+		return INVALID_HANDLE_VALUE;
+	}
+
+	memset(&ov, 0, sizeof(ov));
+	ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+	have = 0;
+	while (have < sizeof(greeting)
+			&& Transfer(pipe, &ov, stop, 0, (char *) greeting + have,
+				sizeof(greeting) - have, BROKER_TIMEOUT, &got)) {
+		have += got;
+	}
+	CloseHandle(ov.hEvent);
+
+	if (have < sizeof(greeting)
+			|| (DWORD) greeting[0] != sizeof(greeting) || greeting[1] != 0
+			|| greeting[2] != BROKER_MAGIC
+			|| greeting[3] != BROKER_VERSION) {
+		CloseHandle(pipe);
+		Tcl_AppendResult(interp, "\"", Tcl_GetString(nameObj),
+				"\" is not a winpm broker", NULL);
+		return INVALID_HANDLE_VALUE;
+	}
+
+	return pipe;
+}
+
+static int
+Connect (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	Tcl_Obj *nameObj
+	)
+{
+	Winpm_Connection *connPtr;
+	HANDLE stop, pipe;
+
+	stop = CreateEvent(NULL, TRUE, FALSE, NULL);
+	pipe = OpenBroker(interp, nameObj, stop);
+	if (pipe == INVALID_HANDLE_VALUE) {
+		CloseHandle(stop);
+		return TCL_ERROR;
+	}
+
+	connPtr = (Winpm_Connection *) ckalloc(sizeof(Winpm_Connection));
+	connPtr->statePtr = statePtr;
+	connPtr->owner = Tcl_GetCurrentThread();
+	connPtr->nameObj = nameObj;
+	connPtr->pipe = pipe;
+	connPtr->stop = stop;
+	connPtr->received = 0;
+
+	if (Tcl_CreateThread(&connPtr->reader, Reader, (ClientData) connPtr,
+			TCL_THREAD_STACK_DEFAULT, TCL_THREAD_JOINABLE) != TCL_OK) {
+		CloseHandle(pipe);
+		CloseHandle(stop);
+		ckfree((char *) connPtr);
+		Tcl_SetResult(interp, "couldn't create thread", TCL_STATIC);
+		return TCL_ERROR;
+	}
+	Tcl_IncrRefCount(nameObj);
+
+	if (statePtr->broker.connPtr != NULL) {
+		Disconnect(statePtr->broker.connPtr);
+	}
+	statePtr->broker.connPtr = connPtr;
+
+	return TCL_OK;
+}
+
+/*
+ * Interface to the rest of the package
+ */
+
+void
+Winpm_InitBroker (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->broker.serverPtr = NULL;
+	statePtr->broker.connPtr = NULL;
+}
+
+/* Stops serving and disconnects from the broker */
+void
+Winpm_FinalizeBroker (
+	Winpm_InterpData *statePtr
+	)
+{
+	if (statePtr->broker.serverPtr != NULL) {
+		StopBroker(statePtr->broker.serverPtr);
+	}
+	if (statePtr->broker.connPtr != NULL) {
+		Disconnect(statePtr->broker.connPtr);
+	}
+	Winpm_InitBroker(statePtr);
+}
+
+/*
+ * Tells whether the class of WM_POWERBROADCAST reaches the interpreter
+ * from its broker, so that the monitoring window must ignore it.
+ */
+int
+Winpm_IsRelayed (
+	Winpm_InterpData *statePtr,
+	WPARAM code
+	)
+{
+	Winpm_EventType *classPtr;
+
+	if (statePtr->broker.connPtr == NULL) return 0;
+
+	classPtr = Winpm_LookupEvent(WM_POWERBROADCAST, code);
+	return classPtr != NULL && (classPtr->type & BROKER_EVENTS) != 0;
+}
+
+/* Returns the state of the broker and the connection for [winpm info] */
+Tcl_Obj *
+Winpm_NewBrokerInfoObj (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_Broker *brokerPtr = statePtr->broker.serverPtr;
+	Winpm_Connection *connPtr = statePtr->broker.connPtr;
+	BrokerClient *clientPtr;
+	Tcl_Obj *elems[12];
+	int clients = 0;
+	long frames = 0, dropped = 0;
+
+	if (brokerPtr != NULL) {
+		ReapClients(brokerPtr);
+
+		Tcl_MutexLock(&brokerPtr->mutex);
+		for (clientPtr = brokerPtr->clients; clientPtr;
+				clientPtr = clientPtr->nextPtr) {
+			++clients;
+			dropped += clientPtr->dropped;
+		}
+		Tcl_MutexUnlock(&brokerPtr->mutex);
+
+		frames = brokerPtr->frames;
+		dropped += brokerPtr->dropped;
+	}
+
+	elems[0] = Tcl_NewStringObj("serving", -1);
+	elems[1] = brokerPtr != NULL ? brokerPtr->nameObj : Tcl_NewObj();
+	elems[2] = Tcl_NewStringObj("clients", -1);
+	elems[3] = Tcl_NewIntObj(clients);
+	elems[4] = Tcl_NewStringObj("frames", -1);
+	elems[5] = Tcl_NewLongObj(frames);
+	elems[6] = Tcl_NewStringObj("dropped", -1);
+	elems[7] = Tcl_NewLongObj(dropped);
+	elems[8] = Tcl_NewStringObj("connected", -1);
+	elems[9] = connPtr != NULL ? connPtr->nameObj : Tcl_NewObj();
+	elems[10] = Tcl_NewStringObj("received", -1);
+	elems[11] = Tcl_NewLongObj(connPtr != NULL ? connPtr->received : 0);
+
+	return Tcl_NewListObj(12, elems);
+}
+
+/*
+ * winpm serve ?name?
+ * winpm connect ?name?
+ *
+ * Without the name returns the name of the pipe served or connected
+ * to, if any; an empty name stops serving or disconnects.
+ */
+int
+Winpm_CmdBroker (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int serve,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	int len;
+
+	if (objc == 2) {
+		if (serve && statePtr->broker.serverPtr != NULL) {
+			Tcl_SetObjResult(interp, statePtr->broker.serverPtr->nameObj);
+		} else if (!serve && statePtr->broker.connPtr != NULL) {
+			Tcl_SetObjResult(interp, statePtr->broker.connPtr->nameObj);
+		}
+		return TCL_OK;
+	}
+
+	if (objc != 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "?name?");
+		return TCL_ERROR;
+	}
+
+	Tcl_GetStringFromObj(objv[2], &len);
+	if (len == 0) {
+		if (serve && statePtr->broker.serverPtr != NULL) {
+			StopBroker(statePtr->broker.serverPtr);
+			statePtr->broker.serverPtr = NULL;
+		} else if (!serve && statePtr->broker.connPtr != NULL) {
+			Disconnect(statePtr->broker.connPtr);
+			statePtr->broker.connPtr = NULL;
+		}
+		return TCL_OK;
+	}
+
+	if (serve) {
+		return StartBroker(interp, statePtr, objv[2]);
+	} else {
+		return Connect(interp, statePtr, objv[2]);
+	}
+}
@@ -0,0 +1,688 @@
+/*
+ * winpmChan.c --
+ *   Power-aware batching of channel output.
+ *
+ *   [winpm chan batch] stacks a transform on a channel which passes the
+ *   output through on AC power but, according to its policy, holds it
+ *   on battery and writes it to the channel below in large chunks: when
+ *   the buffer fills up, when its oldest bytes get too old and when the
+ *   system is about to suspend or the session ends. So a log written
+ *   line by line wakes the disk once in a while instead of on each line.
+ *   The mode of each batched channel follows the power snapshot and is
+ *   reconsidered on every power status change; the buffer is written
+ *   out when the channel switches back to passing the output through.
+ *
+ *   Input is passed through as is.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+#include <errno.h>
+#include <limits.h>
+
+typedef enum {
+	POLICY_BATTERY, /* Batch on battery */
+	POLICY_LOW, /* Batch on battery below the threshold */
+	POLICY_ALWAYS /* Batch regardless of the power status */
+} Policy;
+
+static const char *PolicyNames[] = { "battery", "low", "always", NULL };
+
+struct Winpm_Batch {
+	Winpm_InterpData *statePtr; /* NULL once the interpreter is gone */
+	Tcl_Channel chan; /* The stacked channel */
+	Tcl_Channel parent; /* The one below it */
+	Policy policy;
+	int threshold; /* Battery level batching starts below, percents */
+	int size; /* Bytes which make the buffer full */
+	Tcl_WideInt age; /* Time the bytes may be held for, usecs */
+	int batching; /* Set if the output is being held */
+	char *buf; /* Output held or NULL */
+	int used, allocated; /* Bytes of the buffer */
+	Tcl_TimerToken timer; /* Flushing on age or NULL */
+	long writes; /* Writes to the channel */
+	long flushes; /* Writes to the channel below */
+	long errors; /* Failed writes to the channel below */
+	Winpm_Batch *nextPtr;
+};
+
+static const char *BatchOptions[] = { "-age", "-policy", "-size",
+	"-threshold", NULL };
+typedef enum { COPT_AGE, COPT_POLICY, COPT_SIZE,
+	COPT_THRESHOLD } COPT_Option;
+
+static int  BatchClose (ClientData instanceData, Tcl_Interp *interp);
+static int  BatchInput (ClientData instanceData, char *buf, int toRead,
+		int *errorCodePtr);
+static int  BatchOutput (ClientData instanceData, CONST char *buf,
+		int toWrite, int *errorCodePtr);
+static void BatchWatch (ClientData instanceData, int mask);
+static int  BatchGetHandle (ClientData instanceData, int direction,
+		ClientData *handlePtr);
+static int  BatchBlockMode (ClientData instanceData, int mode);
+static int  BatchHandler (ClientData instanceData, int interestMask);
+
+static Tcl_ChannelType BatchChannelType = {
+	"batch",
+	TCL_CHANNEL_VERSION_5,
+	BatchClose,
+	BatchInput,
+	BatchOutput,
+	NULL, /* seekProc */
+	NULL, /* setOptionProc */
+	NULL, /* getOptionProc */
+	BatchWatch,
+	BatchGetHandle,
+	NULL, /* close2Proc */
+	BatchBlockMode,
+	NULL, /* flushProc */
+	BatchHandler,
+	NULL, /* wideSeekProc */
+	NULL, /* threadActionProc */
+	NULL  /* truncateProc */
+};
+
+void
+Winpm_InitChan (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->chan.head = NULL;
+}
+
+/* Decides whether the output should be held according to the power snapshot */
+static int
+ShouldBatch (
+	Winpm_Batch *batchPtr
+	)
+{
+	Winpm_InterpData *statePtr = batchPtr->statePtr;
+	SYSTEM_POWER_STATUS *statusPtr;
+	int percent;
+
+	if (statePtr == NULL) return 0;
+	if (batchPtr->policy == POLICY_ALWAYS) return 1;
+
+	if (!statePtr->power.valid) return 0;
+	statusPtr = &statePtr->power.snapshot;
+	if (statusPtr->ACLineStatus != 0) return 0;
+
+	if (batchPtr->policy == POLICY_LOW) {
+		percent = Winpm_BatteryPercent(statusPtr->BatteryLifePercent);
+		return percent != -1 && percent < batchPtr->threshold;
+	}
+	return 1;
+}
+
+static void
+CancelAge (
+	Winpm_Batch *batchPtr
+	)
+{
+	if (batchPtr->timer != NULL) {
+		Tcl_DeleteTimerHandler(batchPtr->timer);
+		batchPtr->timer = NULL;
+	}
+}
+
+/*
+ * Writes the output held to the channel below. Returns 0 or the POSIX
+ * error code, in which case the bytes not written are still held.
+ */
+static int
+WriteHeld (
+	Winpm_Batch *batchPtr
+	)
+{
+	int done, n;
+
+	CancelAge(batchPtr);
+	if (batchPtr->used == 0) return 0;
+
+	++batchPtr->flushes;
+	for (done = 0; done < batchPtr->used; done += n) {
+		n = Tcl_WriteRaw(batchPtr->parent, batchPtr->buf + done,
+				batchPtr->used - done);
+		if (n <= 0) {
+			++batchPtr->errors;
+			memmove(batchPtr->buf, batchPtr->buf + done,
+					batchPtr->used - done);
+			batchPtr->used -= done;
+			return n < 0 ? Tcl_GetErrno() : EAGAIN;
+		}
+	}
+
+	batchPtr->used = 0;
+	return 0;
+}
+
+static void AgeExpired (ClientData clientData);
+
+static void
+ArmAge (
+	Winpm_Batch *batchPtr
+	)
+{
+	batchPtr->timer = Tcl_CreateTimerHandler((int) (batchPtr->age / 1000),
+			AgeExpired, (ClientData) batchPtr);
+}
+
+static void
+AgeExpired (
+	ClientData clientData
+	)
+{
+	Winpm_Batch *batchPtr = (Winpm_Batch *) clientData;
+
+	batchPtr->timer = NULL;
+	if (WriteHeld(batchPtr) != 0) {
+		/* Try again later rather than lose the output */
+		ArmAge(batchPtr);
+	}
+}
+
+/* Reconsiders whether to hold the output; stops holding it if not */
+static void
+UpdateMode (
+	Winpm_Batch *batchPtr
+	)
+{
+	batchPtr->batching = ShouldBatch(batchPtr);
+	if (!batchPtr->batching) {
+		WriteHeld(batchPtr);
+	}
+}
+
+/*
+ * Flushes the channel: its own buffers first, then the output held.
+ * Leaves the error code in errno on failure.
+ */
+static int
+FlushBatch (
+	Winpm_Batch *batchPtr
+	)
+{
+	int code, errorCode;
+
+	code = Tcl_Flush(batchPtr->chan);
+	errorCode = WriteHeld(batchPtr);
+	if (errorCode != 0) {
+		Tcl_SetErrno(errorCode);
+		code = TCL_ERROR;
+	}
+	return code;
+}
+
+static void
+UnlinkBatch (
+	Winpm_Batch *batchPtr
+	)
+{
+	Winpm_Batch **linkPtr;
+
+	if (batchPtr->statePtr == NULL) return;
+	for (linkPtr = &batchPtr->statePtr->chan.head; *linkPtr != batchPtr;
+			linkPtr = &(*linkPtr)->nextPtr) {}
+	*linkPtr = batchPtr->nextPtr;
+	Winpm_ReleaseMonitor(batchPtr->statePtr);
+	batchPtr->statePtr = NULL;
+}
+
+/*
+ * The channels outlive the interpreter if they were shared with others;
+ * they write the output held and just pass it through from now on.
+ */
+void
+Winpm_FinalizeChan (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_Batch *batchPtr;
+
+	while (statePtr->chan.head != NULL) {
+		batchPtr = statePtr->chan.head;
+		statePtr->chan.head = batchPtr->nextPtr;
+		batchPtr->statePtr = NULL;
+		UpdateMode(batchPtr);
+	}
+}
+
+/* Reconsiders the mode of each channel. Called when the power snapshot
+ * changes */
+void
+Winpm_UpdateBatches (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_Batch *batchPtr;
+
+	for (batchPtr = statePtr->chan.head; batchPtr;
+			batchPtr = batchPtr->nextPtr) {
+		UpdateMode(batchPtr);
+	}
+}
+
+/* Writes out the output held by all the channels, before the system
+ * suspends or the session ends */
+void
+Winpm_FlushBatches (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_Batch *batchPtr;
+
+	for (batchPtr = statePtr->chan.head; batchPtr;
+			batchPtr = batchPtr->nextPtr) {
+		FlushBatch(batchPtr);
+	}
+}
+
+/*
+ * Called when the channel is closed or unstacked: the output held
+ * goes to the channel below before the transform is gone.
+ */
+static int
+BatchClose (
+	ClientData instanceData,
+	Tcl_Interp *interp
+	)
+{
+	Winpm_Batch *batchPtr = (Winpm_Batch *) instanceData;
+	int errorCode;
+
+	errorCode = WriteHeld(batchPtr);
+	UnlinkBatch(batchPtr);
+	if (batchPtr->buf != NULL) {
+		ckfree(batchPtr->buf);
+	}
+	ckfree((char *) batchPtr);
+
+	return errorCode;
+}
+
+static int
+BatchInput (
+	ClientData instanceData,
+	char *buf,
+	int toRead,
+	int *errorCodePtr
+	)
+{
+	Winpm_Batch *batchPtr = (Winpm_Batch *) instanceData;
+	int n;
+
+	n = Tcl_ReadRaw(batchPtr->parent, buf, toRead);
+	if (n < 0) {
+		*errorCodePtr = Tcl_GetErrno();
+	}
+	return n;
+}
+
+static int
+BatchOutput (
+	ClientData instanceData,
+	CONST char *buf,
+	int toWrite,
+	int *errorCodePtr
+	)
+{
+	Winpm_Batch *batchPtr = (Winpm_Batch *) instanceData;
+	int errorCode, allocated, n;
+	char *newBuf;
+
+	++batchPtr->writes;
+
+	if (!batchPtr->batching && batchPtr->used == 0) {
+		n = Tcl_WriteRaw(batchPtr->parent, buf, toWrite);
+		if (n < 0) {
+			*errorCodePtr = Tcl_GetErrno();
+		}
+		return n;
+	}
+
+	if (toWrite > batchPtr->allocated - batchPtr->used) {
+		newBuf = NULL;
+		if (toWrite <= INT_MAX - batchPtr->used) {
+			allocated = batchPtr->used + toWrite;
+			if (allocated < batchPtr->size) {
+				allocated = batchPtr->size;
+			}
+			newBuf = attemptckrealloc(batchPtr->buf, allocated);
+		}
+		if (newBuf == NULL) {
+			/* No room to hold more: the held bytes go out first */
+			errorCode = WriteHeld(batchPtr);
+			if (errorCode != 0) {
+				*errorCodePtr = errorCode;
+				return -1;
+			}
+			n = Tcl_WriteRaw(batchPtr->parent, buf, toWrite);
+			if (n < 0) {
+				*errorCodePtr = Tcl_GetErrno();
+			}
+			return n;
+		}
+		batchPtr->buf = newBuf;
+		batchPtr->allocated = allocated;
+	}
+	memcpy(batchPtr->buf + batchPtr->used, buf, toWrite);
+	if (batchPtr->used == 0) {
+		ArmAge(batchPtr);
+	}
+	batchPtr->used += toWrite;
+
+	if (!batchPtr->batching || batchPtr->used >= batchPtr->size) {
+		errorCode = WriteHeld(batchPtr);
+		if (errorCode != 0 && errorCode != EAGAIN) {
+			/* The bytes are held, but the writer should know */
+			*errorCodePtr = errorCode;
+			return -1;
+		}
+		if (batchPtr->used > 0 && batchPtr->timer == NULL) {
+			ArmAge(batchPtr);
+		}
+	}
+	return toWrite;
+}
+
+static void
+BatchWatch (
+	ClientData instanceData,
+	int mask
+	)
+{
+	Winpm_Batch *batchPtr = (Winpm_Batch *) instanceData;
+
+	Tcl_ChannelWatchProc(Tcl_GetChannelType(batchPtr->parent))(
+			Tcl_GetChannelInstanceData(batchPtr->parent), mask);
+}
+
+static int
+BatchGetHandle (
+	ClientData instanceData,
+	int direction,
+	ClientData *handlePtr
+	)
+{
+	Winpm_Batch *batchPtr = (Winpm_Batch *) instanceData;
+
+	return Tcl_GetChannelHandle(batchPtr->parent, direction, handlePtr);
+}
+
+static int
+BatchBlockMode (
+	ClientData instanceData,
+	int mode
+	)
+{
+	return 0;
+}
+
+static int
+BatchHandler (
+	ClientData instanceData,
+	int interestMask
+	)
+{
+	return interestMask;
+}
+
+static Tcl_Obj *
+NewBatchInfoObj (
+	Winpm_Batch *batchPtr
+	)
+{
+	Tcl_Obj *elems[20];
+
+	elems[0]  = Tcl_NewStringObj(BatchOptions[COPT_POLICY], -1);
+	elems[1]  = Tcl_NewStringObj(PolicyNames[batchPtr->policy], -1);
+	elems[2]  = Tcl_NewStringObj(BatchOptions[COPT_THRESHOLD], -1);
+	elems[3]  = Tcl_NewIntObj(batchPtr->threshold);
+	elems[4]  = Tcl_NewStringObj(BatchOptions[COPT_SIZE], -1);
+	elems[5]  = Tcl_NewIntObj(batchPtr->size);
+	elems[6]  = Tcl_NewStringObj(BatchOptions[COPT_AGE], -1);
+	elems[7]  = Winpm_NewIntervalObj(batchPtr->age);
+	elems[8]  = Tcl_NewStringObj("mode", -1);
+	elems[9]  = Tcl_NewStringObj(batchPtr->batching
+			? "batch" : "pass", -1);
+	elems[10] = Tcl_NewStringObj("held", -1);
+	elems[11] = Tcl_NewIntObj(batchPtr->used);
+	elems[12] = Tcl_NewStringObj("writes", -1);
+	elems[13] = Tcl_NewLongObj(batchPtr->writes);
+	elems[14] = Tcl_NewStringObj("flushes", -1);
+	elems[15] = Tcl_NewLongObj(batchPtr->flushes);
+	elems[16] = Tcl_NewStringObj("errors", -1);
+	elems[17] = Tcl_NewLongObj(batchPtr->errors);
+
+	return Tcl_NewListObj(18, elems);
+}
+
+/*
+ * Parses the batching options from objv (which must have even objc)
+ * into the record. Nothing is changed on error.
+ */
+static int
+ConfigureBatch (
+	Tcl_Interp *interp,
+	Winpm_Batch *batchPtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Winpm_Batch new;
+	int i, opt, value;
+
+	new = *batchPtr;
+
+	for (i = 0; i < objc; i += 2) {
+		if (Tcl_GetIndexFromObj(interp, objv[i], BatchOptions, "option",
+				0, &opt) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		switch (opt) {
+			case COPT_AGE:
+				if (Winpm_GetIntervalFromObj(interp, objv[i+1],
+						&new.age) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				if (new.age < 1000) {
+					Tcl_SetResult(interp, "bad value for -age: "
+							"must be at least 1ms", TCL_STATIC);
+					return TCL_ERROR;
+				}
+			break;
+
+			case COPT_POLICY:
+				if (Tcl_GetIndexFromObj(interp, objv[i+1], PolicyNames,
+						"policy", 0, &value) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				new.policy = (Policy) value;
+			break;
+
+			case COPT_SIZE:
+			case COPT_THRESHOLD:
+				if (Tcl_GetIntFromObj(interp, objv[i+1], &value) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				if (opt == COPT_SIZE
+						? value < 1 || value > WINPM_BATCH_SIZE_MAX
+						: value < 0 || value > 100) {
+					Tcl_AppendResult(interp, "bad value for ",
+							BatchOptions[opt], ": \"",
+							Tcl_GetString(objv[i+1]), "\"", NULL);
+					return TCL_ERROR;
+				}
+				if (opt == COPT_SIZE) {
+					new.size = value;
+				} else {
+					new.threshold = value;
+				}
+			break;
+		}
+	}
+
+	*batchPtr = new;
+	return TCL_OK;
+}
+
+/*
+ * Returns the transform on top of the channel named by objPtr or NULL,
+ * leaving the message in the interpreter, if the channel isn't batched.
+ */
+static Winpm_Batch *
+GetBatchFromObj (
+	Tcl_Interp *interp,
+	Tcl_Obj *objPtr
+	)
+{
+	Tcl_Channel chan;
+
+	chan = Tcl_GetChannel(interp, Tcl_GetString(objPtr), NULL);
+	if (chan == NULL) {
+		return NULL;
+	}
+	chan = Tcl_GetTopChannel(chan);
+	if (Tcl_GetChannelType(chan) != &BatchChannelType) {
+		Tcl_AppendResult(interp, "channel \"", Tcl_GetString(objPtr),
+				"\" isn't batched", NULL);
+		return NULL;
+	}
+	return (Winpm_Batch *) Tcl_GetChannelInstanceData(chan);
+}
+
+/*
+ * winpm chan batch channel ?-option value ...?
+ * winpm chan unbatch channel
+ * winpm chan flush channel
+ * winpm chan info channel
+ */
+int
+Winpm_CmdChan (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *subcmds[] = { "batch", "flush", "info",
+		"unbatch", NULL };
+	typedef enum { CHAN_BATCH, CHAN_FLUSH, CHAN_INFO,
+		CHAN_UNBATCH } CHAN_Option;
+	Winpm_Batch *batchPtr, new;
+	Tcl_Channel chan;
+	int opt, mode;
+
+	if (objc < 4) {
+		Tcl_WrongNumArgs(interp, 2, objv, "subcommand channel ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], subcmds, "subcommand",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	switch (opt) {
+		case CHAN_BATCH:
+			if (objc % 2 == 1) {
+				Tcl_WrongNumArgs(interp, 3, objv,
+						"channel ?-option value ...?");
+				return TCL_ERROR;
+			}
+
+			chan = Tcl_GetChannel(interp, Tcl_GetString(objv[3]), &mode);
+			if (chan == NULL) {
+				return TCL_ERROR;
+			}
+			chan = Tcl_GetTopChannel(chan);
+
+			/* Batching a batched channel reconfigures it */
+			if (Tcl_GetChannelType(chan) == &BatchChannelType) {
+				batchPtr = (Winpm_Batch *) Tcl_GetChannelInstanceData(chan);
+				if (ConfigureBatch(interp, batchPtr,
+						objc - 4, objv + 4) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				UpdateMode(batchPtr);
+				if (batchPtr->used >= batchPtr->size) {
+					WriteHeld(batchPtr);
+				}
+				return TCL_OK;
+			}
+
+			if (!(mode & TCL_WRITABLE)) {
+				Tcl_AppendResult(interp, "channel \"",
+						Tcl_GetString(objv[3]),
+						"\" wasn't opened for writing", NULL);
+				return TCL_ERROR;
+			}
+
+			memset(&new, 0, sizeof(new));
+			new.policy = POLICY_BATTERY;
+			new.threshold = WINPM_BATCH_THRESHOLD;
+			new.size = WINPM_BATCH_SIZE;
+			new.age = WINPM_BATCH_AGE;
+			if (ConfigureBatch(interp, &new, objc - 4, objv + 4) != TCL_OK) {
+				return TCL_ERROR;
+			}
+
+			/* Channels follow the power status changes */
+			if (Winpm_HoldMonitor(statePtr) != TCL_OK) {
+				return TCL_ERROR;
+			}
+
+			batchPtr = (Winpm_Batch *) ckalloc(sizeof(Winpm_Batch));
+			*batchPtr = new;
+			batchPtr->chan = Tcl_StackChannel(interp, &BatchChannelType,
+					(ClientData) batchPtr, mode, chan);
+			if (batchPtr->chan == NULL) {
+				ckfree((char *) batchPtr);
+				Winpm_ReleaseMonitor(statePtr);
+				return TCL_ERROR;
+			}
+			batchPtr->parent = Tcl_GetStackedChannel(batchPtr->chan);
+			batchPtr->statePtr = statePtr;
+			batchPtr->nextPtr = statePtr->chan.head;
+			statePtr->chan.head = batchPtr;
+			batchPtr->batching = ShouldBatch(batchPtr);
+			return TCL_OK;
+		break;
+
+		case CHAN_FLUSH:
+		case CHAN_INFO:
+		case CHAN_UNBATCH:
+			if (objc != 4) {
+				Tcl_WrongNumArgs(interp, 3, objv, "channel");
+				return TCL_ERROR;
+			}
+
+			batchPtr = GetBatchFromObj(interp, objv[3]);
+			if (batchPtr == NULL) {
+				return TCL_ERROR;
+			}
+
+			if (opt == CHAN_INFO) {
+				Tcl_SetObjResult(interp, NewBatchInfoObj(batchPtr));
+				return TCL_OK;
+			}
+			if (opt == CHAN_UNBATCH) {
+				/* Output held is written when the transform is closed */
+				return Tcl_UnstackChannel(interp, batchPtr->chan);
+			}
+			if (FlushBatch(batchPtr) != TCL_OK) {
+				Tcl_AppendResult(interp, "error flushing \"",
+						Tcl_GetString(objv[3]), "\": ",
+						Tcl_PosixError(interp), NULL);
+				return TCL_ERROR;
+			}
+			return TCL_OK;
+		break;
+	}
+
+	return TCL_OK;
+}
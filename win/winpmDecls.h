@@ -0,0 +1,103 @@
+/*
+ * winpmDecls.h --
+ *
+ *	Declarations of functions in the public winpm API
+ *	exported via the stubs table.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#ifndef _WINPMDECLS
+#define _WINPMDECLS
+
+/*
+ * WARNING: This file is automatically generated by the tools/genStubs.tcl
+ * script from the win/winpm.decls file. Any modifications to the function
+ * declarations below should be made in the winpm.decls script.
+ */
+
+/* !BEGIN!: Do not edit below this line. */
+
+/*
+ * Exported function declarations:
+ */
+
+#ifndef Winpm_CreateShutdownHandler_TCL_DECLARED
+#define Winpm_CreateShutdownHandler_TCL_DECLARED
+/* 0 */
+EXTERN int		Winpm_CreateShutdownHandler (Tcl_Interp * interp,
+				CONST char * name, Winpm_ShutdownProc * proc,
+				ClientData clientData);
+#endif
+#ifndef Winpm_DeleteShutdownHandler_TCL_DECLARED
+#define Winpm_DeleteShutdownHandler_TCL_DECLARED
+/* 1 */
+EXTERN int		Winpm_DeleteShutdownHandler (Tcl_Interp * interp,
+				CONST char * name);
+#endif
+#ifndef Winpm_Subscribe_TCL_DECLARED
+#define Winpm_Subscribe_TCL_DECLARED
+/* 2 */
+EXTERN int		Winpm_Subscribe (Tcl_Interp * interp, int eventMask,
+				Winpm_EventProc * proc,
+				ClientData clientData);
+#endif
+#ifndef Winpm_Unsubscribe_TCL_DECLARED
+#define Winpm_Unsubscribe_TCL_DECLARED
+/* 3 */
+EXTERN int		Winpm_Unsubscribe (Tcl_Interp * interp,
+				int eventMask, Winpm_EventProc * proc,
+				ClientData clientData);
+#endif
+
+typedef struct WinpmStubs {
+    int magic;
+    struct WinpmStubHooks *hooks;
+
+    int (*winpm_CreateShutdownHandler) (Tcl_Interp * interp, CONST char * name, Winpm_ShutdownProc * proc, ClientData clientData); /* 0 */
+    int (*winpm_DeleteShutdownHandler) (Tcl_Interp * interp, CONST char * name); /* 1 */
+    int (*winpm_Subscribe) (Tcl_Interp * interp, int eventMask, Winpm_EventProc * proc, ClientData clientData); /* 2 */
+    int (*winpm_Unsubscribe) (Tcl_Interp * interp, int eventMask, Winpm_EventProc * proc, ClientData clientData); /* 3 */
+} WinpmStubs;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern WinpmStubs *winpmStubsPtr;
+#ifdef __cplusplus
+}
+#endif
+
+#if defined(USE_WINPM_STUBS) && !defined(USE_WINPM_STUB_PROCS)
+
+/*
+ * Inline function declarations:
+ */
+
+#ifndef Winpm_CreateShutdownHandler
+#define Winpm_CreateShutdownHandler \
+	(winpmStubsPtr->winpm_CreateShutdownHandler) /* 0 */
+#endif
+#ifndef Winpm_DeleteShutdownHandler
+#define Winpm_DeleteShutdownHandler \
+	(winpmStubsPtr->winpm_DeleteShutdownHandler) /* 1 */
+#endif
+#ifndef Winpm_Subscribe
+#define Winpm_Subscribe \
+	(winpmStubsPtr->winpm_Subscribe) /* 2 */
+#endif
+#ifndef Winpm_Unsubscribe
+#define Winpm_Unsubscribe \
+	(winpmStubsPtr->winpm_Unsubscribe) /* 3 */
+#endif
+
+#endif /* defined(USE_WINPM_STUBS) && !defined(USE_WINPM_STUB_PROCS) */
+
+/* !END!: Do not edit above this line. */
+
+#endif /* _WINPMDECLS */
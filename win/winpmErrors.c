@@ -0,0 +1,279 @@
+/*
+ * winpmErrors.c --
+ *   Reporting errors in the scripts bound to events.
+ *
+ *   A script failing on each of a burst of events would have Tk show
+ *   a stack of error dialogs, one per event. So only the first error
+ *   of a binding is reported at once; after that the binding is quiet
+ *   and its errors are only counted until the next tick of the summary
+ *   timer, which reports how many there were. A binding without errors
+ *   since the previous tick becomes loud again. Optionally a binding
+ *   is disabled after failing a number of times in a row.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+static void ReportSummaries (ClientData clientData);
+
+void
+Winpm_InitErrors (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->errors.interval = WINPM_ERROR_INTERVAL;
+	statePtr->errors.limit = 0;
+	statePtr->errors.timer = NULL;
+}
+
+void
+Winpm_FinalizeErrors (
+	Winpm_InterpData *statePtr
+	)
+{
+	if (statePtr->errors.timer != NULL) {
+		Tcl_DeleteTimerHandler(statePtr->errors.timer);
+		statePtr->errors.timer = NULL;
+	}
+}
+
+static void
+StartTimer (
+	Winpm_InterpData *statePtr
+	)
+{
+	if (statePtr->errors.timer == NULL) {
+		statePtr->errors.timer = Tcl_CreateTimerHandler(
+				(int) (statePtr->errors.interval / 1000),
+				ReportSummaries, (ClientData) statePtr);
+	}
+}
+
+/*
+ * Reports the errors of the binding counted since the last report,
+ * if any. Returns 1 if there were some.
+ */
+int
+Winpm_FlushErrors (
+	Winpm_InterpData *statePtr,
+	Winpm_Binding *bindPtr,
+	CONST char *event
+	)
+{
+	Tcl_Interp *interp = statePtr->interp;
+	Tcl_InterpState saved;
+	char buf[TCL_INTEGER_SPACE];
+
+	if (bindPtr->failures.suppressed == 0) return 0;
+
+	sprintf(buf, "%d", bindPtr->failures.suppressed);
+	bindPtr->failures.suppressed = 0;
+
+	/* The result of the interpreter is left intact */
+	saved = Tcl_SaveInterpState(interp, TCL_OK);
+	Tcl_ResetResult(interp);
+	Tcl_AppendResult(interp, buf, " more errors in the command bound to ",
+			event, " " PACKAGE_NAME " event", NULL);
+	Tcl_BackgroundError(interp);
+	Tcl_RestoreInterpState(interp, saved);
+
+	return 1;
+}
+
+static void
+ReportSummaries (
+	ClientData clientData
+	)
+{
+	Winpm_InterpData *statePtr = (Winpm_InterpData *) clientData;
+	Winpm_Binding *bindPtr;
+	int again = 0, id;
+
+	statePtr->errors.timer = NULL;
+
+	for (id = 0; id < Winpm_CountEvents(); ++id) {
+		bindPtr = statePtr->bindings[id];
+		if (bindPtr == NULL) continue;
+		if (Winpm_FlushErrors(statePtr, bindPtr,
+				Winpm_GetEventType(id)->name)) {
+			again = 1;
+		} else {
+			bindPtr->failures.quiet = 0;
+		}
+	}
+
+	/* The bindings still failing stay quiet for one more period */
+	if (again) {
+		StartTimer(statePtr);
+	}
+}
+
+/*
+ * Called with the error of the script of the binding left in the
+ * interpreter: reports the error or only counts it, and disables
+ * the binding if it has failed too many times in a row.
+ */
+void
+Winpm_ReportError (
+	Winpm_InterpData *statePtr,
+	Winpm_Binding *bindPtr,
+	CONST char *event
+	)
+{
+	Tcl_Interp *interp = statePtr->interp;
+	char buf[TCL_INTEGER_SPACE];
+
+	++bindPtr->failures.consecutive;
+
+	if (bindPtr->failures.quiet) {
+		++bindPtr->failures.suppressed;
+		++bindPtr->stats.suppressed;
+		Tcl_ResetResult(interp);
+	} else {
+		Tcl_BackgroundError(interp);
+		bindPtr->failures.quiet = 1;
+		StartTimer(statePtr);
+	}
+
+	if (statePtr->errors.limit > 0 && !bindPtr->failures.disabled
+			&& bindPtr->failures.consecutive >= statePtr->errors.limit) {
+		bindPtr->failures.disabled = 1;
+
+		sprintf(buf, "%d", bindPtr->failures.consecutive);
+		Tcl_ResetResult(interp);
+		Tcl_AppendResult(interp, "command bound to ", event, " "
+				PACKAGE_NAME " event disabled after failing ", buf,
+				" times in a row", NULL);
+		Tcl_BackgroundError(interp);
+	}
+}
+
+static const char *ConfigOptions[] = { "-interval", "-maxfailures", NULL };
+typedef enum { OPT_INTERVAL, OPT_MAXFAILURES } CFG_Option;
+
+static Tcl_Obj *
+NewOptionObj (
+	Winpm_InterpData *statePtr,
+	int opt
+	)
+{
+	if (opt == OPT_INTERVAL) {
+		return Winpm_NewIntervalObj(statePtr->errors.interval);
+	} else {
+		return Tcl_NewIntObj(statePtr->errors.limit);
+	}
+}
+
+/* winpm errors configure ?-option ?value ...?? */
+static int
+CmdConfigure (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Tcl_WideInt interval;
+	int i, opt, limit;
+
+	if (objc == 3) {
+		Tcl_Obj *listObj;
+
+		listObj = Tcl_NewListObj(0, NULL);
+		for (i = 0; ConfigOptions[i] != NULL; ++i) {
+			Tcl_ListObjAppendElement(interp, listObj,
+					Tcl_NewStringObj(ConfigOptions[i], -1));
+			Tcl_ListObjAppendElement(interp, listObj,
+					NewOptionObj(statePtr, i));
+		}
+		Tcl_SetObjResult(interp, listObj);
+		return TCL_OK;
+	}
+
+	if (objc == 4) {
+		if (Tcl_GetIndexFromObj(interp, objv[3], ConfigOptions, "option",
+				0, &opt) != TCL_OK) { return TCL_ERROR; }
+		Tcl_SetObjResult(interp, NewOptionObj(statePtr, opt));
+		return TCL_OK;
+	}
+
+	if (objc % 2 == 0) {
+		Tcl_WrongNumArgs(interp, 3, objv, "?-option value ...?");
+		return TCL_ERROR;
+	}
+
+	interval = statePtr->errors.interval;
+	limit = statePtr->errors.limit;
+
+	for (i = 3; i < objc; i += 2) {
+		if (Tcl_GetIndexFromObj(interp, objv[i], ConfigOptions, "option",
+				0, &opt) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		switch (opt) {
+			case OPT_INTERVAL:
+				if (Winpm_GetIntervalFromObj(interp, objv[i+1],
+						&interval) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				if (interval < 1000) {
+					Tcl_AppendResult(interp, "bad value for -interval: \"",
+							Tcl_GetString(objv[i+1]), "\"", NULL);
+					return TCL_ERROR;
+				}
+			break;
+
+			case OPT_MAXFAILURES:
+				if (Tcl_GetIntFromObj(interp, objv[i+1], &limit) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				if (limit < 0) {
+					Tcl_AppendResult(interp, "bad value for -maxfailures: \"",
+							Tcl_GetString(objv[i+1]), "\"", NULL);
+					return TCL_ERROR;
+				}
+			break;
+		}
+	}
+
+	/* The new period starts with the next error */
+	statePtr->errors.interval = interval;
+	statePtr->errors.limit = limit;
+	return TCL_OK;
+}
+
+/* winpm errors subcommand ?arg ...? */
+int
+Winpm_CmdErrors (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *subcmds[] = { "configure", NULL };
+	typedef enum { ERR_CONFIGURE } ERR_Option;
+	int opt;
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "subcommand ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], subcmds, "subcommand",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	switch (opt) {
+		case ERR_CONFIGURE:
+			return CmdConfigure(interp, statePtr, objc, objv);
+		break;
+	}
+
+	return TCL_OK;
+}
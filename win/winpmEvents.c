@@ -0,0 +1,175 @@
+/*
+ * winpmEvents.c --
+ *   Registry of the types of events scripts can be bound to.
+ *
+ *   Each source of events registers the descriptions of its events
+ *   when the package is initialized in an interpreter: the name, the
+ *   bit subscribers get the event as, the message and class it's
+ *   routed from, the decoder of the payload of that message and what
+ *   answering a query means. Registration assigns each type a small
+ *   integer id, which is the index of its binding in the table every
+ *   interpreter keeps, so the dispatcher finds bindings without
+ *   looking up names. The registry is shared by all the threads of
+ *   the process; types are only ever added, so ids and names, once
+ *   handed out, stay valid.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+TCL_DECLARE_MUTEX(registryMutex);
+
+static struct {
+	Winpm_EventType *types[WINPM_MAX_EVENTS]; /* Indexed by id */
+	CONST char *names[WINPM_MAX_EVENTS + 1]; /* For Tcl_GetIndexFromObj */
+	int count;
+} Registry;
+
+static int
+IsRegistered (
+	CONST Winpm_EventType *typePtr
+	)
+{
+	return typePtr->id < Registry.count
+		&& Registry.types[typePtr->id] == typePtr;
+}
+
+/*
+ * Registers the array of event types terminated by the one with the
+ * NULL name, assigning them ids. Types already registered (by the
+ * initialization in another interpreter) are left as they are.
+ */
+void
+Winpm_RegisterEvents (
+	Winpm_EventType *typesPtr
+	)
+{
+	Winpm_EventType *typePtr;
+
+	Tcl_MutexLock(&registryMutex);
+	for (typePtr = typesPtr; typePtr->name != NULL; ++typePtr) {
+		if (IsRegistered(typePtr)) continue;
+		if (Registry.count == WINPM_MAX_EVENTS) {
+			Tcl_MutexUnlock(&registryMutex);
+			Tcl_Panic("%s: too many event types", PACKAGE_NAME);
+		}
+		typePtr->id = Registry.count;
+		Registry.types[typePtr->id] = typePtr;
+		/* The terminating NULL is already there */
+		Registry.names[typePtr->id] = typePtr->name;
+		++Registry.count;
+	}
+	Tcl_MutexUnlock(&registryMutex);
+}
+
+int
+Winpm_CountEvents (void)
+{
+	return Registry.count;
+}
+
+Winpm_EventType *
+Winpm_GetEventType (
+	int id
+	)
+{
+	return Registry.types[id];
+}
+
+/*
+ * Returns the type of the event the class of the message stands for
+ * or NULL if the class is unknown.
+ */
+Winpm_EventType *
+Winpm_LookupEvent (
+	UINT uMsg,
+	WPARAM code
+	)
+{
+	int id;
+
+	for (id = 0; id < Registry.count; ++id) {
+		if (Registry.types[id]->uMsg == uMsg
+				&& Registry.types[id]->code == code) {
+			return Registry.types[id];
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Returns the first registered type subscribers get as the WINPM_* bit,
+ * which is the name the event is reported under, or NULL if none.
+ */
+Winpm_EventType *
+Winpm_FindEventType (
+	int type
+	)
+{
+	int id;
+
+	for (id = 0; id < Registry.count; ++id) {
+		if (Registry.types[id]->type == type) {
+			return Registry.types[id];
+		}
+	}
+	return NULL;
+}
+
+int
+Winpm_GetEventTypeFromObj (
+	Tcl_Interp *interp,
+	Tcl_Obj *objPtr,
+	Winpm_EventType **typePtrPtr
+	)
+{
+	int id;
+
+	if (Tcl_GetIndexFromObj(interp, objPtr, Registry.names, "event",
+			0, &id) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	*typePtrPtr = Registry.types[id];
+	return TCL_OK;
+}
+
+/* Returns the names of the registered events, in order of their ids */
+Tcl_Obj *
+Winpm_NewEventNamesObj (void)
+{
+	Tcl_Obj *listObj;
+	int id;
+
+	listObj = Tcl_NewListObj(0, NULL);
+	for (id = 0; id < Registry.count; ++id) {
+		Tcl_ListObjAppendElement(NULL, listObj,
+				Tcl_NewStringObj(Registry.names[id], -1));
+	}
+	return listObj;
+}
+
+/* Returns the description of the type for [winpm info event] */
+Tcl_Obj *
+Winpm_NewEventTypeObj (
+	CONST Winpm_EventType *typePtr
+	)
+{
+	Tcl_Obj *elems[8];
+
+	elems[0] = Tcl_NewStringObj("id", -1);
+	elems[1] = Tcl_NewIntObj(typePtr->id);
+	elems[2] = Tcl_NewStringObj("query", -1);
+	elems[3] = Tcl_NewBooleanObj(typePtr->flags & WINPM_EVENT_QUERY);
+	elems[4] = Tcl_NewStringObj("stagger", -1);
+	elems[5] = Tcl_NewBooleanObj(typePtr->flags & WINPM_EVENT_RESUME);
+	elems[6] = Tcl_NewStringObj("listen", -1);
+	elems[7] = Tcl_NewBooleanObj(typePtr->type != 0);
+
+	return Tcl_NewListObj(8, elems);
+}
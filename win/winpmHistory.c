@@ -0,0 +1,584 @@
+/*
+ * winpmHistory.c --
+ *   Recording the history of the power status.
+ *
+ *   The power status is sampled each minute and on each change of it,
+ *   and the samples are kept in a file mapped into memory at three
+ *   levels of detail: the raw samples, the samples rolled up by minute
+ *   and by hour. Each level is a ring of fixed-size records in time
+ *   order, so a query picks the coarsest level suiting its step and
+ *   finds the first record of interest by binary search; the oldest
+ *   records of a level are overwritten when its ring is full.
+ *
+ *   A rollup record covers one period of its level: the record of the
+ *   current period is updated in place by each sample, and the next
+ *   period starts a new record.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+#define HISTORY_MAGIC   0x4D505448 /* "HTPM" */
+#define HISTORY_VERSION 1
+
+/* Milliseconds between the samples taken regardless of changes */
+#define HISTORY_PERIOD 60000
+
+#define LEVELS 3
+
+/* Period of each level in seconds; the raw samples have none */
+static CONST int Periods[LEVELS] = { 0, 60, 3600 };
+
+/* Capacity of each level: a week, a month and a year */
+#define RAW_RECORDS    10080
+#define MINUTE_RECORDS 44640
+#define HOUR_RECORDS   8784
+
+static CONST DWORD Capacities[LEVELS] = {
+	RAW_RECORDS, MINUTE_RECORDS, HOUR_RECORDS
+};
+
+/* Samples summed up over a period; for the raw samples it's one */
+typedef struct {
+	Tcl_WideInt time; /* Start of the period, seconds since the epoch */
+	LONG samples; /* Number of samples taken */
+	LONG online; /* Samples taken on AC power */
+	LONG known; /* Samples with the battery charge known */
+	LONG sum; /* Of the known charges, percents */
+	LONG min, max; /* Of the known charges */
+	LONG first, last; /* The first and the last known charges */
+	LONG firstAt, lastAt; /* Seconds from the start they were taken at */
+} HistoryRecord;
+
+/* Layout of the file */
+struct Winpm_History {
+	DWORD magic;
+	DWORD version;
+	DWORD capacity[LEVELS];
+	LONG count[LEVELS]; /* Records ever appended to each level */
+	HistoryRecord raw[RAW_RECORDS];
+	HistoryRecord minutes[MINUTE_RECORDS];
+	HistoryRecord hours[HOUR_RECORDS];
+};
+
+/* Returns the record of the level with the given ordinal number */
+static HistoryRecord *
+GetRecord (
+	Winpm_History *historyPtr,
+	int level,
+	LONG n
+	)
+{
+	HistoryRecord *records;
+
+	switch (level) {
+		case 0:  records = historyPtr->raw; break;
+		case 1:  records = historyPtr->minutes; break;
+		default: records = historyPtr->hours; break;
+	}
+	return &records[n % Capacities[level]];
+}
+
+/* Returns the ordinal number of the oldest record kept at the level */
+static LONG
+OldestRecord (
+	Winpm_History *historyPtr,
+	int level
+	)
+{
+	LONG count = historyPtr->count[level];
+
+	return count > (LONG) Capacities[level]
+		? count - (LONG) Capacities[level] : 0;
+}
+
+/* Adds the sample summed up in the second record to the first one */
+static void
+MergeRecord (
+	HistoryRecord *recPtr,
+	CONST HistoryRecord *samplePtr
+	)
+{
+	LONG offset = (LONG) (samplePtr->time - recPtr->time);
+
+	recPtr->samples += samplePtr->samples;
+	recPtr->online += samplePtr->online;
+	if (samplePtr->known == 0) return;
+
+	if (recPtr->known == 0) {
+		recPtr->min = samplePtr->min;
+		recPtr->max = samplePtr->max;
+		recPtr->first = samplePtr->first;
+		recPtr->firstAt = samplePtr->firstAt + offset;
+	} else {
+		if (samplePtr->min < recPtr->min) recPtr->min = samplePtr->min;
+		if (samplePtr->max > recPtr->max) recPtr->max = samplePtr->max;
+	}
+	recPtr->known += samplePtr->known;
+	recPtr->sum += samplePtr->sum;
+	recPtr->last = samplePtr->last;
+	recPtr->lastAt = samplePtr->lastAt + offset;
+}
+
+/* Starts an empty record for the period starting at the time */
+static void
+ClearRecord (
+	HistoryRecord *recPtr,
+	Tcl_WideInt time
+	)
+{
+	memset(recPtr, 0, sizeof(HistoryRecord));
+	recPtr->time = time;
+}
+
+/*
+ * Takes a sample of the power status at the time given in seconds
+ * and adds it to each level of the history being recorded.
+ */
+static void
+TakeSample (
+	Winpm_InterpData *statePtr,
+	Tcl_WideInt now
+	)
+{
+	Winpm_History *historyPtr = statePtr->history.viewPtr;
+	SYSTEM_POWER_STATUS status;
+	HistoryRecord sample, *recPtr;
+	Tcl_WideInt start;
+	int level;
+	LONG count;
+
+	if (historyPtr == NULL) return;
+
+	ClearRecord(&sample, now);
+	sample.samples = 1;
+	if (Winpm_GetPowerStatus(statePtr, &status)) {
+		sample.online = status.ACLineStatus == 1;
+		if (status.BatteryLifePercent != 255) {
+			sample.known = 1;
+			sample.sum = sample.min = sample.max =
+				sample.first = sample.last = status.BatteryLifePercent;
+		}
+	}
+
+	for (level = 0; level < LEVELS; ++level) {
+		count = historyPtr->count[level];
+		recPtr = count > 0 ? GetRecord(historyPtr, level, count - 1) : NULL;
+
+		/* Keep the records in order if the clock is set back */
+		if (recPtr != NULL && sample.time < recPtr->time) {
+			sample.time = recPtr->time;
+		}
+
+		start = Periods[level] == 0
+			? sample.time : sample.time - sample.time % Periods[level];
+		if (recPtr == NULL || Periods[level] == 0 || recPtr->time != start) {
+			recPtr = GetRecord(historyPtr, level, count);
+			ClearRecord(recPtr, start);
+			InterlockedIncrement(&historyPtr->count[level]);
+		}
+		MergeRecord(recPtr, &sample);
+	}
+}
+
+/* Samples the power status; called each time it may have changed */
+void
+Winpm_RecordPower (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_Time now;
+
+	Tcl_GetTime(&now);
+	TakeSample(statePtr, (Tcl_WideInt) now.sec);
+}
+
+static void
+SampleTimerProc (
+	ClientData clientData
+	)
+{
+	Winpm_InterpData *statePtr = (Winpm_InterpData *) clientData;
+
+	statePtr->history.timer = Tcl_CreateTimerHandler(HISTORY_PERIOD,
+			SampleTimerProc, (ClientData) statePtr);
+	Winpm_RecordPower(statePtr);
+}
+
+void
+Winpm_InitHistory (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->history.file = INVALID_HANDLE_VALUE;
+	statePtr->history.mapping = NULL;
+	statePtr->history.viewPtr = NULL;
+	statePtr->history.pathObj = NULL;
+	statePtr->history.timer = NULL;
+}
+
+/* Unmaps the file, if any, and stops recording */
+void
+Winpm_FinalizeHistory (
+	Winpm_InterpData *statePtr
+	)
+{
+	if (statePtr->history.timer != NULL) {
+		Tcl_DeleteTimerHandler(statePtr->history.timer);
+	}
+	if (statePtr->history.viewPtr != NULL) {
+		FlushViewOfFile((LPCVOID) statePtr->history.viewPtr, 0);
+		UnmapViewOfFile((LPCVOID) statePtr->history.viewPtr);
+	}
+	if (statePtr->history.mapping != NULL) {
+		CloseHandle(statePtr->history.mapping);
+	}
+	if (statePtr->history.file != INVALID_HANDLE_VALUE) {
+		CloseHandle(statePtr->history.file);
+	}
+	if (statePtr->history.pathObj != NULL) {
+		Tcl_DecrRefCount(statePtr->history.pathObj);
+		Winpm_ReleaseMonitor(statePtr);
+	}
+	Winpm_InitHistory(statePtr);
+}
+
+/*
+ * Opens and maps the file, creating it if needed; the records already
+ * in the file are kept. Returns TCL_ERROR, leaving the message in the
+ * interpreter, on failure; nothing is changed in that case.
+ */
+static int
+MapFile (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	Tcl_Obj *pathObj
+	)
+{
+	CONST TCHAR *nativePath;
+	HANDLE file, mapping;
+	Winpm_History *historyPtr;
+	DWORD error;
+	int level;
+
+	nativePath = (CONST TCHAR *) Tcl_FSGetNativePath(pathObj);
+	if (nativePath == NULL) {
+		Tcl_AppendResult(interp, "bad path \"", Tcl_GetString(pathObj),
+				"\"", NULL);
+		return TCL_ERROR;
+	}
+
+	file = CreateFile(nativePath, GENERIC_READ | GENERIC_WRITE,
+			FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		error = GetLastError();
+		goto systemError;
+	}
+
+	/* A new file is extended with zeroes */
+	mapping = CreateFileMapping(file, NULL, PAGE_READWRITE,
+			0, sizeof(Winpm_History), NULL);
+	if (mapping == NULL) {
+		error = GetLastError();
+		CloseHandle(file);
+		goto systemError;
+	}
+
+	historyPtr = (Winpm_History *) MapViewOfFile(mapping, FILE_MAP_WRITE,
+			0, 0, sizeof(Winpm_History));
+	if (historyPtr == NULL) {
+		error = GetLastError();
+		CloseHandle(mapping);
+		CloseHandle(file);
+		goto systemError;
+	}
+
+	if (historyPtr->magic == 0) {
+		historyPtr->version = HISTORY_VERSION;
+		for (level = 0; level < LEVELS; ++level) {
+			historyPtr->capacity[level] = Capacities[level];
+			historyPtr->count[level] = 0;
+		}
+		historyPtr->magic = HISTORY_MAGIC;
+	} else if (historyPtr->magic != HISTORY_MAGIC
+			|| historyPtr->version != HISTORY_VERSION
+			|| memcmp(historyPtr->capacity, Capacities,
+				sizeof(Capacities)) != 0) {
+		UnmapViewOfFile((LPCVOID) historyPtr);
+		CloseHandle(mapping);
+		CloseHandle(file);
+		Tcl_AppendResult(interp, "\"", Tcl_GetString(pathObj),
+				"\" is not a power history", NULL);
+		return TCL_ERROR;
+	}
+
+	Winpm_FinalizeHistory(statePtr);
+
+	statePtr->history.file = file;
+	statePtr->history.mapping = mapping;
+	statePtr->history.viewPtr = historyPtr;
+	statePtr->history.pathObj = pathObj;
+	Tcl_IncrRefCount(pathObj);
+
+	return TCL_OK;
+
+systemError:
+	Tcl_AppendResult(interp, "couldn't map \"", Tcl_GetString(pathObj),
+			"\": ", NULL);
+	Winpm_AppendSystemError(interp, error);
+	return TCL_ERROR;
+}
+
+/* winpm history record ?path? */
+static int
+CmdRecord (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	int len;
+
+	if (objc == 3) {
+		if (statePtr->history.pathObj != NULL) {
+			Tcl_SetObjResult(interp, statePtr->history.pathObj);
+		}
+		return TCL_OK;
+	}
+
+	if (objc != 4) {
+		Tcl_WrongNumArgs(interp, 3, objv, "?path?");
+		return TCL_ERROR;
+	}
+
+	Tcl_GetStringFromObj(objv[3], &len);
+	if (len == 0) {
+		Winpm_FinalizeHistory(statePtr);
+		return TCL_OK;
+	}
+
+	/* The changes of the power status are sampled too */
+	if (Winpm_HoldMonitor(statePtr) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	if (MapFile(interp, statePtr, objv[3]) != TCL_OK) {
+		Winpm_ReleaseMonitor(statePtr);
+		return TCL_ERROR;
+	}
+
+	statePtr->history.timer = Tcl_CreateTimerHandler(HISTORY_PERIOD,
+			SampleTimerProc, (ClientData) statePtr);
+	Winpm_RecordPower(statePtr);
+	return TCL_OK;
+}
+
+/* Returns the record of the period as reported by queries */
+static Tcl_Obj *
+NewRecordObj (
+	CONST HistoryRecord *recPtr
+	)
+{
+	Tcl_Obj *dictObj = Tcl_NewDictObj();
+
+#define PUT(key, valueObj) \
+	Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj(key, -1), valueObj)
+
+	PUT("time", Tcl_NewWideIntObj(recPtr->time));
+	PUT("samples", Tcl_NewLongObj(recPtr->samples));
+	PUT("ac", Tcl_NewIntObj((int)
+			(recPtr->online * 100 / recPtr->samples)));
+	if (recPtr->known > 0) {
+		PUT("percent", Tcl_NewIntObj((int) (recPtr->sum / recPtr->known)));
+		PUT("min", Tcl_NewIntObj((int) recPtr->min));
+		PUT("max", Tcl_NewIntObj((int) recPtr->max));
+	} else {
+		PUT("percent", Tcl_NewIntObj(-1));
+		PUT("min", Tcl_NewIntObj(-1));
+		PUT("max", Tcl_NewIntObj(-1));
+	}
+	if (recPtr->lastAt > recPtr->firstAt) {
+		PUT("rate", Tcl_NewDoubleObj((double) (recPtr->last - recPtr->first)
+				* 3600 / (recPtr->lastAt - recPtr->firstAt)));
+	} else {
+		PUT("rate", Tcl_NewObj());
+	}
+
+#undef PUT
+
+	return dictObj;
+}
+
+static const char *QueryOptions[] = { "-from", "-step", "-to", NULL };
+typedef enum { QRY_FROM, QRY_STEP, QRY_TO } QRY_Option;
+
+/* winpm history query ?-from seconds? ?-to seconds? ?-step seconds? */
+static int
+CmdQuery (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Winpm_History *historyPtr = statePtr->history.viewPtr;
+	Tcl_WideInt from, to, step, start;
+	HistoryRecord *recPtr, bucket;
+	LONG lo, hi, mid, count;
+	Tcl_Obj *listObj;
+	int i, opt, level, bounded;
+
+	if (historyPtr == NULL) {
+		Tcl_AppendResult(interp, "no power history is recorded", NULL);
+		return TCL_ERROR;
+	}
+
+	if (objc % 2 == 0) {
+		Tcl_WrongNumArgs(interp, 3, objv, "?-option value ...?");
+		return TCL_ERROR;
+	}
+
+	from = to = step = 0;
+	bounded = 0;
+
+	for (i = 3; i < objc; i += 2) {
+		Tcl_WideInt value;
+
+		if (Tcl_GetIndexFromObj(interp, objv[i], QueryOptions, "option",
+				0, &opt) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		if (Tcl_GetWideIntFromObj(interp, objv[i+1], &value) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		switch (opt) {
+			case QRY_FROM:
+				from = value;
+			break;
+
+			case QRY_STEP:
+				if (value < 0) {
+					Tcl_AppendResult(interp, "bad value for -step: \"",
+							Tcl_GetString(objv[i+1]), "\"", NULL);
+					return TCL_ERROR;
+				}
+				step = value;
+			break;
+
+			case QRY_TO:
+				to = value;
+				bounded = 1;
+			break;
+		}
+	}
+
+	/* The coarsest level whose periods make up the steps */
+	for (level = LEVELS - 1; level > 0; --level) {
+		if (step >= Periods[level] && step % Periods[level] == 0) break;
+	}
+
+	/* The first record of a period ending after the start */
+	count = historyPtr->count[level];
+	lo = OldestRecord(historyPtr, level);
+	hi = count;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		recPtr = GetRecord(historyPtr, level, mid);
+		if (recPtr->time + Periods[level] <= from) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	listObj = Tcl_NewListObj(0, NULL);
+	bucket.samples = 0;
+	for (; lo < count; ++lo) {
+		recPtr = GetRecord(historyPtr, level, lo);
+		if (bounded && recPtr->time > to) break;
+
+		start = step == 0 ? recPtr->time : recPtr->time - recPtr->time % step;
+		if (bucket.samples > 0 && bucket.time != start) {
+			Tcl_ListObjAppendElement(interp, listObj, NewRecordObj(&bucket));
+			bucket.samples = 0;
+		}
+		if (bucket.samples == 0) {
+			ClearRecord(&bucket, start);
+		}
+		MergeRecord(&bucket, recPtr);
+	}
+	if (bucket.samples > 0) {
+		Tcl_ListObjAppendElement(interp, listObj, NewRecordObj(&bucket));
+	}
+
+	Tcl_SetObjResult(interp, listObj);
+	return TCL_OK;
+}
+
+/* winpm history subcommand ?arg ...? */
+int
+Winpm_CmdHistory (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *subcmds[] = { "query", "record", NULL };
+	typedef enum { HST_QUERY, HST_RECORD } HST_Option;
+	int opt;
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "subcommand ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], subcmds, "subcommand",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	switch (opt) {
+		case HST_QUERY:
+			return CmdQuery(interp, statePtr, objc, objv);
+		break;
+
+		case HST_RECORD:
+			return CmdRecord(interp, statePtr, objc, objv);
+		break;
+	}
+
+	return TCL_OK;
+}
+
+/*
+ * winpm _history seconds
+ *
+ * Takes a sample at the given time, for testing.
+ */
+int
+Winpm_CmdHistorySample (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Tcl_WideInt now;
+
+	if (objc != 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "seconds");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetWideIntFromObj(interp, objv[2], &now) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	TakeSample(statePtr, now);
+	return TCL_OK;
+}
@@ -0,0 +1,271 @@
+/*
+ * winpmIdle.c --
+ *   User idle detection.
+ *
+ *   Windows only tells how long ago the last input was made, so the
+ *   transitions between the active and idle user are found by a timer
+ *   of the monitoring window running while USER_IDLE or USER_ACTIVE is
+ *   bound. The timer is not polling at a fixed rate: while the user is
+ *   active it is set to expire exactly when the threshold would be
+ *   reached if no more input comes, so an active user costs one tick
+ *   per threshold; only while the user is idle it checks for input
+ *   every WINPM_IDLE_POLL milliseconds.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+static Winpm_EventType IdleEvents[] = {
+	{ WINPM_IDLE_EVENT, WINPM_USERIDLE, 0, 0, 0,
+		NULL, Winpm_UpdateIdleTimer },
+	{ WINPM_ACTIVE_EVENT, WINPM_USERACTIVE, 0, 0, 0,
+		NULL, Winpm_UpdateIdleTimer },
+	{ NULL }
+};
+typedef enum { EV_IDLE, EV_ACTIVE } EV_Idle;
+
+void
+Winpm_InitIdle (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_RegisterEvents(IdleEvents);
+	statePtr->idle.threshold = WINPM_IDLE_THRESHOLD;
+	statePtr->idle.idle = 0;
+	statePtr->idle.simulate = 0;
+}
+
+void
+Winpm_FinalizeIdle (
+	Winpm_InterpData *statePtr
+	)
+{
+	KillTimer(statePtr->hwndMonitor, WINPM_TIMER_IDLE);
+}
+
+/*
+ * Returns the number of milliseconds since the last input,
+ * either the real one or the one set for testing.
+ */
+long
+Winpm_GetIdleTime (
+	Winpm_InterpData *statePtr
+	)
+{
+	LASTINPUTINFO info;
+
+	if (statePtr->idle.simulate) {
+		return (long) (GetTickCount() - statePtr->idle.simulated);
+	}
+
+	info.cbSize = sizeof(info);
+	if (!GetLastInputInfo(&info)) return 0;
+
+	/* Both are tick counts, so this survives their wrapping */
+	return (long) (GetTickCount() - info.dwTime);
+}
+
+/*
+ * Starts, restarts or stops the timer according to the bindings
+ * and the state of the user. Called each time the binding for
+ * USER_IDLE or USER_ACTIVE or the threshold changes.
+ */
+void
+Winpm_UpdateIdleTimer (
+	Winpm_InterpData *statePtr
+	)
+{
+	long idle;
+	UINT period;
+
+	if (Winpm_FindBinding(statePtr, &IdleEvents[EV_IDLE]) == NULL
+			&& Winpm_FindBinding(statePtr, &IdleEvents[EV_ACTIVE]) == NULL) {
+		KillTimer(statePtr->hwndMonitor, WINPM_TIMER_IDLE);
+		statePtr->idle.idle = 0;
+		return;
+	}
+
+	if (statePtr->idle.idle) {
+		period = WINPM_IDLE_POLL;
+	} else {
+		/* Any input in the meantime only postpones the transition */
+		idle = Winpm_GetIdleTime(statePtr);
+		if (idle < statePtr->idle.threshold) {
+			period = (UINT) (statePtr->idle.threshold - idle);
+		} else {
+			period = 1;
+		}
+	}
+	SetTimer(statePtr->hwndMonitor, WINPM_TIMER_IDLE, period, NULL);
+}
+
+/* Called when the timer of the monitoring window fires */
+void
+Winpm_SampleIdle (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_Event event;
+	Winpm_PercentMap map[2];
+	char ibuf[TCL_INTEGER_SPACE];
+	long idle;
+	int isIdle;
+
+	idle = Winpm_GetIdleTime(statePtr);
+	isIdle = idle >= statePtr->idle.threshold;
+
+	if (isIdle != statePtr->idle.idle) {
+		statePtr->idle.idle = isIdle;
+
+		memset(&event, 0, sizeof(event));
+		event.type = isIdle ? WINPM_USERIDLE : WINPM_USERACTIVE;
+		event.power.changed = -1;
+		event.idle.time = idle;
+
+		sprintf(ibuf, "%ld", idle);
+		map[0].token = 'i';
+		map[0].value = ibuf;
+		map[1].token = '\0';
+
+		Winpm_FireEvent(statePtr, &event, map,
+				&IdleEvents[isIdle ? EV_IDLE : EV_ACTIVE]);
+	}
+
+	/* The scripts are free to rebind the events */
+	Winpm_UpdateIdleTimer(statePtr);
+}
+
+/* winpm idle configure ?-threshold ?interval?? */
+static int
+CmdConfigure (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *options[] = { "-threshold", NULL };
+	Tcl_WideInt threshold;
+	int opt;
+
+	if (objc == 3) {
+		Tcl_Obj *elems[2];
+
+		elems[0] = Tcl_NewStringObj(options[0], -1);
+		elems[1] = Winpm_NewIntervalObj(
+				(Tcl_WideInt) statePtr->idle.threshold * 1000);
+		Tcl_SetObjResult(interp, Tcl_NewListObj(2, elems));
+		return TCL_OK;
+	}
+
+	if (objc != 4 && objc != 5) {
+		Tcl_WrongNumArgs(interp, 3, objv, "?-option ?value??");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[3], options, "option",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	if (objc == 4) {
+		Tcl_SetObjResult(interp, Winpm_NewIntervalObj(
+				(Tcl_WideInt) statePtr->idle.threshold * 1000));
+		return TCL_OK;
+	}
+
+	if (Winpm_GetIntervalFromObj(interp, objv[4], &threshold) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	if (threshold < 1000) {
+		Tcl_AppendResult(interp, "bad value for -threshold: \"",
+				Tcl_GetString(objv[4]), "\"", NULL);
+		return TCL_ERROR;
+	}
+
+	statePtr->idle.threshold = (int) (threshold / 1000);
+	Winpm_UpdateIdleTimer(statePtr);
+	return TCL_OK;
+}
+
+/* winpm idle subcommand ?arg ...? */
+int
+Winpm_CmdIdle (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *subcmds[] = { "configure", "state", NULL };
+	typedef enum { IDL_CONFIGURE, IDL_STATE } IDL_Option;
+	int opt;
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "subcommand ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], subcmds, "subcommand",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	switch (opt) {
+		case IDL_CONFIGURE:
+			return CmdConfigure(interp, statePtr, objc, objv);
+		break;
+
+		case IDL_STATE:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			Tcl_SetResult(interp,
+					statePtr->idle.idle ? "idle" : "active", TCL_STATIC);
+			return TCL_OK;
+		break;
+	}
+
+	return TCL_OK;
+}
+
+/*
+ * winpm _idle ms|reset
+ *
+ * Makes the last input appear to have happened ms milliseconds ago
+ * and checks the state of the user at once, or goes back to the real
+ * input information.
+ */
+int
+Winpm_CmdIdleTime (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	long ms;
+
+	if (objc != 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "ms|reset");
+		return TCL_ERROR;
+	}
+
+	if (strcmp(Tcl_GetString(objv[2]), "reset") == 0) {
+		statePtr->idle.simulate = 0;
+		Winpm_UpdateIdleTimer(statePtr);
+		return TCL_OK;
+	}
+
+	if (Tcl_GetLongFromObj(interp, objv[2], &ms) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	statePtr->idle.simulate = 1;
+	statePtr->idle.simulated = GetTickCount() - (DWORD) ms;
+	Winpm_SampleIdle(statePtr);
+	return TCL_OK;
+}
@@ -0,0 +1,256 @@
+/*
+ * winpmInhibit.c --
+ *   Keeping the system from sleeping while long jobs run.
+ *
+ *   Since Vista the system no longer asks applications whether it may
+ *   suspend, so the only way to prevent that is to tell it in advance
+ *   that the system is required. Holders of inhibit locks are counted
+ *   process-wide, across all interpreters and threads, and only the
+ *   transitions between zero and non-zero holders reach the system.
+ *
+ *   SetThreadExecutionState() sets the state of the calling thread and
+ *   the state is dropped when that thread ends, while holders may come
+ *   and go on any thread. So the state is set by a "keeper" thread
+ *   started when the first lock is taken; it waits until the last lock
+ *   is released, resets the state and exits.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+/* Process-wide state protected by inhibitMutex */
+TCL_DECLARE_MUTEX(inhibitMutex);
+static Tcl_Condition released; /* Notified when count drops to zero */
+static int count = 0; /* Number of locks held in the process */
+static int keeperRunning = 0; /* Set while the keeper thread runs */
+static long activations = 0; /* Number of times the keeper was started */
+
+static Tcl_ThreadCreateType
+Keeper (
+	ClientData clientData
+	)
+{
+	Tcl_MutexLock(&inhibitMutex);
+	SetThreadExecutionState(ES_CONTINUOUS | ES_SYSTEM_REQUIRED);
+	while (count > 0) {
+		Tcl_ConditionWait(&released, &inhibitMutex, NULL);
+	}
+	SetThreadExecutionState(ES_CONTINUOUS);
+	keeperRunning = 0;
+	Tcl_MutexUnlock(&inhibitMutex);
+
+	TCL_THREAD_CREATE_RETURN;
+}
+
+/* Takes a lock; returns 0 if the system couldn't be told about it */
+static int
+Acquire (void)
+{
+	Tcl_ThreadId id;
+	int ok = 1;
+
+	Tcl_MutexLock(&inhibitMutex);
+	if (count == 0 && !keeperRunning) {
+		if (Tcl_CreateThread(&id, Keeper, NULL,
+				TCL_THREAD_STACK_DEFAULT, TCL_THREAD_NOFLAGS) == TCL_OK) {
+			keeperRunning = 1;
+			++activations;
+		} else {
+			ok = 0;
+		}
+	}
+	if (ok) ++count;
+	Tcl_MutexUnlock(&inhibitMutex);
+
+	return ok;
+}
+
+static void
+Release (void)
+{
+	Tcl_MutexLock(&inhibitMutex);
+	if (--count == 0) {
+		Tcl_ConditionNotify(&released);
+	}
+	Tcl_MutexUnlock(&inhibitMutex);
+}
+
+void
+Winpm_InitInhibit (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_InitHashTable(&statePtr->inhibit.locks, TCL_STRING_KEYS);
+	statePtr->inhibit.nextId = 1;
+}
+
+void
+Winpm_FinalizeInhibit (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_HashEntry *entryPtr;
+	Tcl_HashSearch search;
+
+	/* Locks die with their interpreter */
+	entryPtr = Tcl_FirstHashEntry(&statePtr->inhibit.locks, &search);
+	while (entryPtr != NULL) {
+		Tcl_DecrRefCount((Tcl_Obj *) Tcl_GetHashValue(entryPtr));
+		Release();
+		entryPtr = Tcl_NextHashEntry(&search);
+	}
+	Tcl_DeleteHashTable(&statePtr->inhibit.locks);
+}
+
+static Tcl_Obj *
+NewInhibitInfoObj (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_HashEntry *entryPtr;
+	Tcl_HashSearch search;
+	Tcl_Obj *elems[4], *locksObj;
+	int n;
+
+	locksObj = Tcl_NewListObj(0, NULL);
+	entryPtr = Tcl_FirstHashEntry(&statePtr->inhibit.locks, &search);
+	while (entryPtr != NULL) {
+		Tcl_ListObjAppendElement(NULL, locksObj, Tcl_NewStringObj(
+				Tcl_GetHashKey(&statePtr->inhibit.locks, entryPtr), -1));
+		Tcl_ListObjAppendElement(NULL, locksObj,
+				(Tcl_Obj *) Tcl_GetHashValue(entryPtr));
+		entryPtr = Tcl_NextHashEntry(&search);
+	}
+
+	Tcl_MutexLock(&inhibitMutex);
+	n = count;
+	Tcl_MutexUnlock(&inhibitMutex);
+
+	elems[0] = Tcl_NewStringObj("count", -1);
+	elems[1] = Tcl_NewIntObj(n);
+	elems[2] = Tcl_NewStringObj("locks", -1);
+	elems[3] = locksObj;
+
+	return Tcl_NewListObj(4, elems);
+}
+
+/*
+ * winpm inhibit ?-reason text?
+ * winpm inhibit release handle
+ * winpm inhibit info
+ */
+int
+Winpm_CmdInhibit (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *subcmds[] = { "info", "release", NULL };
+	typedef enum { INH_INFO, INH_RELEASE } INH_Option;
+	static const char *options[] = { "-reason", NULL };
+	Tcl_HashEntry *entryPtr;
+	Tcl_Obj *reasonObj;
+	char handle[TCL_INTEGER_SPACE + 8];
+	int opt, isNew;
+
+	if (objc == 2 || Tcl_GetString(objv[2])[0] == '-') {
+		reasonObj = NULL;
+		if (objc == 4) {
+			if (Tcl_GetIndexFromObj(interp, objv[2], options, "option",
+					0, &opt) != TCL_OK) { return TCL_ERROR; }
+			reasonObj = objv[3];
+		} else if (objc != 2) {
+			Tcl_WrongNumArgs(interp, 2, objv, "?-reason text?");
+			return TCL_ERROR;
+		}
+
+		if (!Acquire()) {
+			Tcl_SetResult(interp, "couldn't start the thread "
+					"keeping the system awake", TCL_STATIC);
+			return TCL_ERROR;
+		}
+
+		if (reasonObj == NULL) {
+			reasonObj = Tcl_NewObj();
+		}
+		Tcl_IncrRefCount(reasonObj);
+
+		sprintf(handle, "inhibit%d", statePtr->inhibit.nextId++);
+		entryPtr = Tcl_CreateHashEntry(&statePtr->inhibit.locks,
+				handle, &isNew);
+		Tcl_SetHashValue(entryPtr, (ClientData) reasonObj);
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(handle, -1));
+		return TCL_OK;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], subcmds, "subcommand",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	switch (opt) {
+		case INH_INFO:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult(interp, NewInhibitInfoObj(statePtr));
+			return TCL_OK;
+		break;
+
+		case INH_RELEASE:
+			if (objc != 4) {
+				Tcl_WrongNumArgs(interp, 3, objv, "handle");
+				return TCL_ERROR;
+			}
+			entryPtr = Tcl_FindHashEntry(&statePtr->inhibit.locks,
+					Tcl_GetString(objv[3]));
+			if (entryPtr == NULL) {
+				Tcl_AppendResult(interp, "no such inhibit lock \"",
+						Tcl_GetString(objv[3]), "\"", NULL);
+				return TCL_ERROR;
+			}
+			Tcl_DecrRefCount((Tcl_Obj *) Tcl_GetHashValue(entryPtr));
+			Tcl_DeleteHashEntry(entryPtr);
+			Release();
+			return TCL_OK;
+		break;
+	}
+
+	return TCL_OK;
+}
+
+/*
+ * winpm _inhibit
+ *
+ * Returns the number of times the system has been told to stay awake
+ * so far in this process.
+ */
+int
+Winpm_CmdInhibitCount (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	long n;
+
+	if (objc != 2) {
+		Tcl_WrongNumArgs(interp, 2, objv, NULL);
+		return TCL_ERROR;
+	}
+
+	Tcl_MutexLock(&inhibitMutex);
+	n = activations;
+	Tcl_MutexUnlock(&inhibitMutex);
+
+	Tcl_SetObjResult(interp, Tcl_NewLongObj(n));
+	return TCL_OK;
+}
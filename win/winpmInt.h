@@ -0,0 +1,519 @@
+/*
+ * winpmInt.h --
+ *   Declarations shared between the source files of the winpm package.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#ifndef _WINPMINT
+#define _WINPMINT
+
+#ifdef _MSC_VER
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <tchar.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <pbt.h> /* MinGW's windows.h doesn't include it for some reason */
+
+#ifndef ENDSESSION_CLOSEAPP
+#define ENDSESSION_CLOSEAPP 0x00000001L
+#endif
+
+#ifndef PBT_APMRESUMEAUTOMATIC
+#define PBT_APMRESUMEAUTOMATIC 0x0012
+#endif
+
+#ifndef WM_WTSSESSION_CHANGE
+#define WM_WTSSESSION_CHANGE 0x02B1
+#endif
+
+/* Vista+ power setting notifications, missing from older headers */
+#ifndef PBT_POWERSETTINGCHANGE
+#define PBT_POWERSETTINGCHANGE 0x8013
+typedef struct {
+	GUID PowerSetting;
+	DWORD DataLength;
+	UCHAR Data[1];
+} POWERBROADCAST_SETTING;
+#endif
+
+#include <tcl.h>
+#include <tk.h>
+#include <tkPlatDecls.h>
+
+#include "winpm.h"
+
+/* Key under which the per-interp state is registered
+ * as the interpreter's associated data */
+#define WINPM_ASSOC_KEY PACKAGE_NAME
+
+/* Number of power settings the monitoring window registers for */
+#define WINPM_SETTINGS 4
+
+/* Identifiers of the timers of the monitoring window */
+#define WINPM_TIMER_THERMAL 1
+#define WINPM_TIMER_MEMORY  2
+#define WINPM_TIMER_IDLE    3
+
+/* Memory pressure event and the defaults of its binding */
+#define WINPM_MEMORY_EVENT     "MEMORY_PRESSURE"
+#define WINPM_MEMORY_THRESHOLD 90 /* Percents of memory load */
+#define WINPM_MEMORY_WINDOW    1000000 /* Microseconds */
+
+/* User idle events and the timing of their detection */
+#define WINPM_IDLE_EVENT     "USER_IDLE"
+#define WINPM_ACTIVE_EVENT   "USER_ACTIVE"
+#define WINPM_IDLE_THRESHOLD 300000 /* Default, milliseconds */
+#define WINPM_IDLE_POLL      1000 /* Input check period while idle, ms */
+
+/* Change of the system time */
+#define WINPM_TIMECHANGE_EVENT "TIME_CHANGE"
+
+/* How the delay of a staggered resume binding is chosen */
+#define WINPM_SPREAD_RANDOM 0
+#define WINPM_SPREAD_HOST   1
+
+/* Defaults of batched channels: bytes which make the buffer full,
+ * time the output may be held for (microseconds) and battery level
+ * the "low" policy starts batching below */
+#define WINPM_BATCH_SIZE      65536
+#define WINPM_BATCH_SIZE_MAX  16777216 /* Largest -size allowed */
+#define WINPM_BATCH_AGE       10000000
+#define WINPM_BATCH_THRESHOLD 50
+
+/* Default period of error summaries, microseconds */
+#define WINPM_ERROR_INTERVAL 10000000
+
+/* Default period of a scheduled job, microseconds */
+#define WINPM_JOB_INTERVAL 1000000
+
+/* Max number of the types of events registered in the process */
+#define WINPM_MAX_EVENTS 64
+
+/* Values substituted for %-tokens in the scripts. Arrays of these
+ * are terminated by an entry with the zero token */
+typedef struct {
+	char token;
+	CONST char *value;
+} Winpm_PercentMap;
+
+typedef struct Winpm_ShutdownHandler Winpm_ShutdownHandler;
+typedef struct Winpm_QueuedMessage Winpm_QueuedMessage;
+typedef struct Winpm_Subscriber Winpm_Subscriber;
+typedef struct Winpm_Staggered Winpm_Staggered;
+typedef struct Winpm_SharedPower Winpm_SharedPower;
+typedef struct Winpm_Broker Winpm_Broker;
+typedef struct Winpm_Connection Winpm_Connection;
+typedef struct Winpm_History Winpm_History;
+typedef struct Winpm_AsyncRun Winpm_AsyncRun;
+typedef struct Winpm_Batch Winpm_Batch;
+
+/* Script bound to an event along with its options and statistics */
+typedef struct {
+	Tcl_Obj *scriptObj;
+	Tcl_WideInt budget; /* Max run time in microseconds, 0 = unlimited */
+	int fields; /* WINPM_POWER_* bits the script is run for, 0 = any */
+	int threshold; /* Memory load for MEMORY_PRESSURE, percents */
+	Tcl_WideInt window; /* Sampling period for MEMORY_PRESSURE, usecs */
+	Tcl_WideInt stagger; /* Max delay of resume handlers, usecs, 0 = none */
+	int spread; /* WINPM_SPREAD_* */
+	int async; /* Set if the script is launched as a coroutine */
+	struct {
+		long calls;
+		long errors;
+		long overruns; /* Runs over the budget, queries not waited for */
+		long suppressed; /* Errors reported only in summaries */
+	} stats;
+	struct {
+		int consecutive; /* Failed runs in a row */
+		int suppressed; /* Errors counted since the last summary */
+		int quiet; /* Set while errors are only counted */
+		int disabled; /* Set after failing too many times in a row */
+	} failures;
+} Winpm_Binding;
+
+typedef struct {
+	Tcl_Interp *interp; /* Interpreter to which this state belongs */
+	HWND hwndMonitor; /* Handle to the monitoring window or NULL */
+	int holds; /* Number of users of the monitoring window */
+	Winpm_Binding *bindings[WINPM_MAX_EVENTS]; /* Event id -> binding */
+	Winpm_Staggered *staggered; /* Delayed runs of resume handlers */
+	struct {
+		ULONG uMsg;
+		WPARAM wParam;
+		LPARAM lParam;
+	} last;
+	struct {
+		SYSTEM_POWER_STATUS snapshot; /* As of the last status change */
+		int valid; /* Set if the snapshot could be taken */
+		SYSTEM_POWER_STATUS simulated; /* Reported instead of the real one */
+		int simulate; /* Set while testing */
+	} power;
+	struct {
+		HANDLE file, mapping; /* Published or attached file */
+		Winpm_SharedPower *viewPtr; /* Its mapped contents or NULL */
+		int publisher; /* Set if publishing, clear if attached */
+		Tcl_Obj *pathObj; /* Path of the file or NULL */
+		Tcl_TimerToken heartbeat; /* Stamping the published file or NULL */
+	} shared;
+	struct {
+		HANDLE file, mapping; /* File the history is recorded in */
+		Winpm_History *viewPtr; /* Its mapped contents or NULL */
+		Tcl_Obj *pathObj; /* Path of the file or NULL */
+		Tcl_TimerToken timer; /* Next sample or NULL */
+	} history;
+	struct {
+		Winpm_Broker *serverPtr; /* Set while serving as a broker */
+		Winpm_Connection *connPtr; /* Set while connected to a broker */
+	} broker;
+	struct {
+		int delivering; /* Set while delivering events to listeners */
+	} listen;
+	struct {
+		Winpm_AsyncRun *head; /* Coroutines running, newest first */
+		long nextId; /* Number of the next run */
+	} async;
+	struct {
+		Winpm_Batch *head; /* Batched channels, newest first */
+	} chan;
+	struct {
+		PVOID notify[WINPM_SETTINGS]; /* Registration handles */
+		int personality; /* WINPM_PROFILE_* */
+		int saver; /* Energy saver is on, -1 if unknown */
+		int lid; /* Lid is open, -1 if unknown */
+		int source; /* WINPM_SOURCE_*, -1 if unknown */
+	} settings;
+	struct {
+		Tcl_HashTable zones; /* Zone name -> last reading */
+		int interval; /* Sampling period in milliseconds, 0 = off */
+		int threshold; /* Degrees Celsius, 0 = none */
+		HANDLE query; /* Performance counters query or NULL */
+		HANDLE temperature, limit; /* Counters of the query */
+		int failed; /* Set if the counters are unavailable */
+	} thermal;
+	struct {
+		int threshold; /* Milliseconds without input to become idle */
+		int idle; /* Set while the user is considered idle */
+		int simulate; /* Set while testing */
+		DWORD simulated; /* Tick count of the simulated last input */
+	} idle;
+	struct {
+		Tcl_WideInt interval; /* Period of the summaries, usecs */
+		int limit; /* Failures in a row disabling a binding, 0 = none */
+		Tcl_TimerToken timer; /* Next summary or NULL */
+	} errors;
+	struct {
+		Tcl_HashTable jobs; /* Job name -> scheduled job */
+	} schedule;
+	struct {
+		Tcl_HashTable locks; /* Handle -> reason */
+		int nextId; /* Number of the next handle */
+	} inhibit;
+	struct {
+		Tcl_HashTable table; /* Id -> suspend-aware timer */
+		int nextId; /* Number of the next timer id */
+		Tcl_WideInt suspended; /* Suspended time as of the last resume */
+		Tcl_WideInt skew; /* Simulated suspended time, milliseconds */
+		Tcl_WideInt offset; /* Wall minus suspend-inclusive clock */
+		Tcl_WideInt step; /* Simulated change of the system time */
+	} timers;
+	struct {
+		Winpm_Subscriber *head; /* In order of subscription */
+		int depth; /* Nesting level of deliveries in progress */
+		int deleted; /* Set if some records await freeing */
+	} subscribers;
+	struct {
+		Winpm_QueuedMessage *head; /* Pending messages, by priority */
+		int depth; /* Nesting level of message processing */
+		int held; /* Set while the queue is frozen for testing */
+		long merged; /* Number of superseded messages merged */
+	} queue;
+	struct {
+		Winpm_ShutdownHandler *handlers; /* In order of registration */
+		int deadline; /* Milliseconds given to the whole phase */
+		int workers; /* Max number of threads running C handlers */
+		Tcl_Obj *results; /* Outcome of the last phase or NULL */
+	} shutdown;
+} Winpm_InterpData;
+
+typedef struct Winpm_EventType Winpm_EventType;
+
+/*
+ * Fills in the description of the event from lParam of the message.
+ * Stores the type of the more specific event the message is fired as
+ * too, if any, to *detailPtr. Returns 0 if only that one is fired.
+ */
+typedef int (Winpm_DecodeProc) (Winpm_InterpData *statePtr, LPARAM lParam,
+		Winpm_Event *eventPtr, Winpm_EventType **detailPtr);
+
+/* Called after the script bound to the event has changed */
+typedef void (Winpm_BindProc) (Winpm_InterpData *statePtr);
+
+/* Flags of the types of events */
+#define WINPM_EVENT_QUERY   1 /* The scripts may deny the request */
+#define WINPM_EVENT_RESUME  2 /* The bindings may be staggered */
+#define WINPM_EVENT_SAMPLED 4 /* The bindings take -threshold and -window */
+
+/* Type of events, as registered by their source */
+struct Winpm_EventType {
+	CONST char *name; /* Scripts are bound to the event by it */
+	int type; /* WINPM_* bit subscribers get the event as, 0 = none */
+	UINT uMsg; /* Message the event is routed from, 0 = not routed */
+	WPARAM code; /* Class of the message the event stands for */
+	int flags; /* WINPM_EVENT_* */
+	Winpm_DecodeProc *decodeProc; /* Or NULL if there's no payload */
+	Winpm_BindProc *bindProc; /* Or NULL */
+	int id; /* Assigned on registration */
+};
+
+/* winpm.c */
+
+Winpm_InterpData *Winpm_GetInterpData (Tcl_Interp *interp);
+void Winpm_AppendSystemError (Tcl_Interp *interp, DWORD error);
+int  Winpm_HoldMonitor (Winpm_InterpData *statePtr);
+void Winpm_ReleaseMonitor (Winpm_InterpData *statePtr);
+Winpm_Binding *Winpm_FindBinding (Winpm_InterpData *statePtr,
+		CONST Winpm_EventType *typePtr);
+int Winpm_DispatchEvent (Winpm_InterpData *statePtr,
+		CONST Winpm_PercentMap *mapPtr, int changed,
+		CONST Winpm_EventType *typePtr);
+int Winpm_DispatchPowerBcast (Winpm_InterpData *statePtr,
+		CONST Winpm_PercentMap *mapPtr, int changed,
+		CONST Winpm_EventType *classPtr);
+int Winpm_FireEvent (Winpm_InterpData *statePtr,
+		CONST Winpm_Event *eventPtr, CONST Winpm_PercentMap *mapPtr,
+		CONST Winpm_EventType *typePtr);
+int Winpm_GetIntervalFromObj (Tcl_Interp *interp, Tcl_Obj *objPtr,
+		Tcl_WideInt *usecPtr);
+Tcl_Obj *Winpm_NewIntervalObj (Tcl_WideInt usec);
+
+int Winpm_EvalLimited (Tcl_Interp *interp, Tcl_Obj *scriptObj,
+		CONST Tcl_Time *deadlinePtr, int *expiredPtr);
+
+LRESULT Winpm_ProcessMessage (Winpm_InterpData *statePtr,
+		UINT uMsg, WPARAM wParam, LPARAM lParam);
+
+/* winpmAfter.c */
+
+void Winpm_InitAfter (Winpm_InterpData *statePtr);
+void Winpm_FinalizeAfter (Winpm_InterpData *statePtr);
+void Winpm_ResumeTimers (Winpm_InterpData *statePtr);
+Tcl_WideInt Winpm_TakeClockStep (Winpm_InterpData *statePtr);
+int  Winpm_CmdAfter (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+int  Winpm_CmdSuspended (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+int  Winpm_CmdTimeChange (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmAsync.c */
+
+void Winpm_InitAsync (Winpm_InterpData *statePtr);
+void Winpm_FinalizeAsync (Winpm_InterpData *statePtr);
+int  Winpm_HasCoroutines (Tcl_Interp *interp);
+int  Winpm_RunAsync (Winpm_InterpData *statePtr, Winpm_Binding *bindPtr,
+		Tcl_Obj *scriptObj, CONST char *event, int wait);
+Tcl_Obj *Winpm_NewAsyncInfoObj (Winpm_InterpData *statePtr);
+int  Winpm_CmdResolve (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmBroker.c */
+
+void Winpm_InitBroker (Winpm_InterpData *statePtr);
+void Winpm_FinalizeBroker (Winpm_InterpData *statePtr);
+int  Winpm_IsRelayed (Winpm_InterpData *statePtr, WPARAM code);
+Tcl_Obj *Winpm_NewBrokerInfoObj (Winpm_InterpData *statePtr);
+int  Winpm_CmdBroker (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int serve, int objc, Tcl_Obj *const objv[]);
+
+/* winpmChan.c */
+
+void Winpm_InitChan (Winpm_InterpData *statePtr);
+void Winpm_FinalizeChan (Winpm_InterpData *statePtr);
+void Winpm_UpdateBatches (Winpm_InterpData *statePtr);
+void Winpm_FlushBatches (Winpm_InterpData *statePtr);
+int  Winpm_CmdChan (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmErrors.c */
+
+void Winpm_InitErrors (Winpm_InterpData *statePtr);
+void Winpm_FinalizeErrors (Winpm_InterpData *statePtr);
+void Winpm_ReportError (Winpm_InterpData *statePtr,
+		Winpm_Binding *bindPtr, CONST char *event);
+int  Winpm_FlushErrors (Winpm_InterpData *statePtr,
+		Winpm_Binding *bindPtr, CONST char *event);
+int  Winpm_CmdErrors (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmThread.c */
+
+void Winpm_InitListen (Winpm_InterpData *statePtr);
+void Winpm_FinalizeListen (Winpm_InterpData *statePtr);
+int  Winpm_CmdListen (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+int  Winpm_CmdDeliver (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmEvents.c */
+
+void Winpm_RegisterEvents (Winpm_EventType *typesPtr);
+int  Winpm_CountEvents (void);
+Winpm_EventType *Winpm_GetEventType (int id);
+Winpm_EventType *Winpm_LookupEvent (UINT uMsg, WPARAM code);
+Winpm_EventType *Winpm_FindEventType (int type);
+int  Winpm_GetEventTypeFromObj (Tcl_Interp *interp, Tcl_Obj *objPtr,
+		Winpm_EventType **typePtrPtr);
+Tcl_Obj *Winpm_NewEventNamesObj (void);
+Tcl_Obj *Winpm_NewEventTypeObj (CONST Winpm_EventType *typePtr);
+
+/* winpmHistory.c */
+
+void Winpm_InitHistory (Winpm_InterpData *statePtr);
+void Winpm_FinalizeHistory (Winpm_InterpData *statePtr);
+void Winpm_RecordPower (Winpm_InterpData *statePtr);
+int  Winpm_CmdHistory (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+int  Winpm_CmdHistorySample (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmIdle.c */
+
+void Winpm_InitIdle (Winpm_InterpData *statePtr);
+void Winpm_FinalizeIdle (Winpm_InterpData *statePtr);
+long Winpm_GetIdleTime (Winpm_InterpData *statePtr);
+void Winpm_UpdateIdleTimer (Winpm_InterpData *statePtr);
+void Winpm_SampleIdle (Winpm_InterpData *statePtr);
+int  Winpm_CmdIdle (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+int  Winpm_CmdIdleTime (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmInhibit.c */
+
+void Winpm_InitInhibit (Winpm_InterpData *statePtr);
+void Winpm_FinalizeInhibit (Winpm_InterpData *statePtr);
+int  Winpm_CmdInhibit (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+int  Winpm_CmdInhibitCount (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmMemory.c */
+
+void Winpm_InitMemory (Winpm_InterpData *statePtr);
+void Winpm_UpdateMemoryTimer (Winpm_InterpData *statePtr);
+void Winpm_SampleMemory (Winpm_InterpData *statePtr);
+void Winpm_ProcessMemorySample (Winpm_InterpData *statePtr,
+		int load, long available);
+int  Winpm_CmdMemorySample (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmNotify.c */
+
+void Winpm_InitNotify (Winpm_InterpData *statePtr);
+void Winpm_FinalizeNotify (Winpm_InterpData *statePtr);
+int  Winpm_NotifySubscribers (Winpm_InterpData *statePtr,
+		CONST Winpm_Event *eventPtr);
+int  Winpm_CmdSubscribe (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmPower.c */
+
+void    Winpm_InitPower (Winpm_InterpData *statePtr);
+BOOL    Winpm_GetPowerStatus (Winpm_InterpData *statePtr,
+		SYSTEM_POWER_STATUS *statusPtr);
+int     Winpm_UpdatePowerSnapshot (Winpm_InterpData *statePtr);
+int     Winpm_SetPowerSnapshot (Winpm_InterpData *statePtr,
+		CONST SYSTEM_POWER_STATUS *nowPtr);
+CONST char *Winpm_ACLineStatusName (BYTE status);
+CONST char *Winpm_BatteryFlagName (BYTE flag);
+int     Winpm_BatteryPercent (BYTE percent);
+Tcl_Obj *Winpm_NewPowerStatusObj (CONST SYSTEM_POWER_STATUS *statusPtr);
+int     Winpm_GetPowerFieldsFromObj (Tcl_Interp *interp, Tcl_Obj *objPtr,
+		int *fieldsPtr);
+Tcl_Obj *Winpm_NewPowerFieldsObj (int fields);
+int     Winpm_CmdPower (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmQueue.c */
+
+void    Winpm_InitQueue (Winpm_InterpData *statePtr);
+void    Winpm_FinalizeQueue (Winpm_InterpData *statePtr);
+LRESULT Winpm_QueueMessage (Winpm_InterpData *statePtr,
+		UINT uMsg, WPARAM wParam, LPARAM lParam);
+Tcl_Obj *Winpm_NewQueueInfoObj (Winpm_InterpData *statePtr);
+int     Winpm_CmdQueue (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmSchedule.c */
+
+void Winpm_InitSchedule (Winpm_InterpData *statePtr);
+void Winpm_FinalizeSchedule (Winpm_InterpData *statePtr);
+void Winpm_RescheduleJobs (Winpm_InterpData *statePtr);
+int  Winpm_CmdSchedule (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmSession.c */
+
+void Winpm_InitSession (Winpm_InterpData *statePtr);
+void Winpm_RegisterSession (Winpm_InterpData *statePtr);
+void Winpm_UnregisterSession (Winpm_InterpData *statePtr);
+void Winpm_ProcessSessionChange (Winpm_InterpData *statePtr,
+		WPARAM wParam, LPARAM lParam);
+CONST char *Winpm_SessionReasonName (int reason);
+
+/* winpmSettings.c */
+
+void Winpm_InitSettings (Winpm_InterpData *statePtr);
+void Winpm_RegisterSettings (Winpm_InterpData *statePtr);
+void Winpm_UnregisterSettings (Winpm_InterpData *statePtr);
+CONST char *Winpm_ProfileName (int personality);
+CONST char *Winpm_PowerSourceName (int source);
+int  Winpm_DecodeSetting (Winpm_InterpData *statePtr, LPARAM lParam,
+		Winpm_Event *eventPtr, Winpm_EventType **detailPtr);
+Tcl_Obj *Winpm_NewProfileObj (Winpm_InterpData *statePtr);
+int  Winpm_CmdSetting (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmShared.c */
+
+void Winpm_InitShared (Winpm_InterpData *statePtr);
+void Winpm_FinalizeShared (Winpm_InterpData *statePtr);
+void Winpm_PublishPower (Winpm_InterpData *statePtr);
+int  Winpm_ReadSharedPower (Winpm_InterpData *statePtr,
+		SYSTEM_POWER_STATUS *statusPtr);
+int  Winpm_CmdShared (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int publish, int objc, Tcl_Obj *const objv[]);
+
+/* winpmShutdown.c */
+
+void Winpm_InitShutdown (Winpm_InterpData *statePtr);
+void Winpm_FinalizeShutdown (Winpm_InterpData *statePtr);
+int  Winpm_RunShutdownPhase (Winpm_InterpData *statePtr);
+int  Winpm_CmdShutdown (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmThermal.c */
+
+void Winpm_InitThermal (Winpm_InterpData *statePtr);
+void Winpm_FinalizeThermal (Winpm_InterpData *statePtr);
+void Winpm_SampleThermal (Winpm_InterpData *statePtr);
+void Winpm_ProcessThermalSample (Winpm_InterpData *statePtr,
+		CONST char *zone, int temperature, int limit);
+int  Winpm_CmdThermal (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+int  Winpm_CmdThermalSample (Tcl_Interp *interp, Winpm_InterpData *statePtr,
+		int objc, Tcl_Obj *const objv[]);
+
+/* winpmStubInit.c */
+
+extern WinpmStubs winpmStubs;
+
+#endif /* _WINPMINT */
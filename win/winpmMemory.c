@@ -0,0 +1,140 @@
+/*
+ * winpmMemory.c --
+ *   Memory pressure events.
+ *
+ *   While a script is bound to MEMORY_PRESSURE the monitoring window
+ *   runs a timer firing once per the window of the binding; on each
+ *   tick the memory load of the system is taken and the event is fired
+ *   if the load is at or above the threshold of the binding. So the
+ *   event is fired at most once per window for as long as the pressure
+ *   persists, and the ticks go through the same event queue as the
+ *   power notifications.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+static Winpm_EventType MemoryEvents[] = {
+	{ WINPM_MEMORY_EVENT, WINPM_MEMORYPRESSURE, 0, 0, WINPM_EVENT_SAMPLED,
+		NULL, Winpm_UpdateMemoryTimer },
+	{ NULL }
+};
+
+void
+Winpm_InitMemory (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_RegisterEvents(MemoryEvents);
+}
+
+/*
+ * Starts, restarts or stops the timer according to the binding.
+ * Called each time the binding for MEMORY_PRESSURE changes.
+ */
+void
+Winpm_UpdateMemoryTimer (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_Binding *bindPtr;
+	UINT period;
+
+	bindPtr = Winpm_FindBinding(statePtr, &MemoryEvents[0]);
+	if (bindPtr == NULL) {
+		KillTimer(statePtr->hwndMonitor, WINPM_TIMER_MEMORY);
+		return;
+	}
+
+	/* -window is from 1ms to INT_MAX ms, so the period neither
+	 * wraps nor becomes the 0 SetTimer would take for "at once" */
+	period = (UINT) (bindPtr->window / 1000);
+	SetTimer(statePtr->hwndMonitor, WINPM_TIMER_MEMORY, period, NULL);
+}
+
+/* Called when the timer of the monitoring window fires */
+void
+Winpm_SampleMemory (
+	Winpm_InterpData *statePtr
+	)
+{
+	MEMORYSTATUSEX status;
+
+	status.dwLength = sizeof(status);
+	if (!GlobalMemoryStatusEx(&status)) return;
+
+	Winpm_ProcessMemorySample(statePtr, (int) status.dwMemoryLoad,
+			(long) (status.ullAvailPhys / (1024 * 1024)));
+}
+
+/*
+ * Fires the event if the memory load is at or above the threshold
+ * of the binding. available is the free physical memory in megabytes.
+ */
+void
+Winpm_ProcessMemorySample (
+	Winpm_InterpData *statePtr,
+	int load,
+	long available
+	)
+{
+	Winpm_Binding *bindPtr;
+	Winpm_Event event;
+	Winpm_PercentMap map[3];
+	char lbuf[TCL_INTEGER_SPACE], abuf[TCL_INTEGER_SPACE];
+
+	bindPtr = Winpm_FindBinding(statePtr, &MemoryEvents[0]);
+	if (bindPtr == NULL || load < bindPtr->threshold) return;
+
+	memset(&event, 0, sizeof(event));
+	event.type = WINPM_MEMORYPRESSURE;
+	event.power.changed = -1;
+	event.memory.load = load;
+	event.memory.available = available;
+
+	sprintf(lbuf, "%d", load);
+	sprintf(abuf, "%ld", available);
+	map[0].token = 'm';
+	map[0].value = lbuf;
+	map[1].token = 'f';
+	map[1].value = abuf;
+	map[2].token = '\0';
+
+	Winpm_FireEvent(statePtr, &event, map, &MemoryEvents[0]);
+}
+
+/*
+ * winpm _memory load available
+ *
+ * Processes the reading as if it was taken by the timer.
+ */
+int
+Winpm_CmdMemorySample (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	int load;
+	long available;
+
+	if (objc != 4) {
+		Tcl_WrongNumArgs(interp, 2, objv, "load available");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIntFromObj(interp, objv[2], &load) != TCL_OK
+			|| Tcl_GetLongFromObj(interp, objv[3], &available) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	Winpm_ProcessMemorySample(statePtr, load, available);
+	return TCL_OK;
+}
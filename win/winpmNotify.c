@@ -0,0 +1,249 @@
+/*
+ * winpmNotify.c --
+ *   Delivery of events to the subscribers registered from C.
+ *
+ *   Subscribers are called directly with the decoded event, without
+ *   evaluating any scripts or formatting anything, so extensions can
+ *   react to power and session events as cheaply as possible.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+struct Winpm_Subscriber {
+	int eventMask;
+	Winpm_EventProc *proc; /* NULL once unsubscribed */
+	ClientData clientData;
+	Winpm_Subscriber *nextPtr;
+};
+
+/*
+ * Frees the records of unsubscribed subscribers. Deferred until no
+ * delivery is in progress so that the list stays walkable.
+ */
+static void
+SweepSubscribers (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_Subscriber **linkPtr, *subPtr;
+
+	linkPtr = &statePtr->subscribers.head;
+	while (*linkPtr != NULL) {
+		subPtr = *linkPtr;
+		if (subPtr->proc == NULL) {
+			*linkPtr = subPtr->nextPtr;
+			ckfree((char *) subPtr);
+		} else {
+			linkPtr = &subPtr->nextPtr;
+		}
+	}
+	statePtr->subscribers.deleted = 0;
+}
+
+void
+Winpm_InitNotify (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->subscribers.head = NULL;
+	statePtr->subscribers.depth = 0;
+	statePtr->subscribers.deleted = 0;
+}
+
+void
+Winpm_FinalizeNotify (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_Subscriber *subPtr, *nextPtr;
+
+	for (subPtr = statePtr->subscribers.head; subPtr; subPtr = nextPtr) {
+		nextPtr = subPtr->nextPtr;
+		ckfree((char *) subPtr);
+	}
+	statePtr->subscribers.head = NULL;
+}
+
+/*
+ * Calls each subscriber interested in the event, in order of
+ * subscription. Returns TCL_CONTINUE if any of them has returned it,
+ * TCL_OK otherwise.
+ */
+int
+Winpm_NotifySubscribers (
+	Winpm_InterpData *statePtr,
+	CONST Winpm_Event *eventPtr
+	)
+{
+	Winpm_Subscriber *subPtr;
+	int code;
+
+	code = TCL_OK;
+
+	++statePtr->subscribers.depth;
+	for (subPtr = statePtr->subscribers.head; subPtr;
+			subPtr = subPtr->nextPtr) {
+		if (subPtr->proc == NULL
+				|| (subPtr->eventMask & eventPtr->type) == 0) {
+			continue;
+		}
+		if (subPtr->proc(subPtr->clientData, eventPtr) == TCL_CONTINUE) {
+			code = TCL_CONTINUE;
+		}
+	}
+	--statePtr->subscribers.depth;
+
+	if (statePtr->subscribers.depth == 0
+			&& statePtr->subscribers.deleted) {
+		SweepSubscribers(statePtr);
+	}
+
+	return code;
+}
+
+/*
+ * Public interface
+ */
+
+int
+Winpm_Subscribe (
+	Tcl_Interp *interp,
+	int eventMask,
+	Winpm_EventProc *proc,
+	ClientData clientData
+	)
+{
+	Winpm_InterpData *statePtr;
+	Winpm_Subscriber *subPtr, **linkPtr;
+
+	statePtr = Winpm_GetInterpData(interp);
+	if (statePtr == NULL) return TCL_ERROR;
+
+	if (Winpm_HoldMonitor(statePtr) != TCL_OK) return TCL_ERROR;
+
+	subPtr = (Winpm_Subscriber *) ckalloc(sizeof(Winpm_Subscriber));
+	subPtr->eventMask = eventMask & WINPM_ALL_EVENTS;
+	subPtr->proc = proc;
+	subPtr->clientData = clientData;
+	subPtr->nextPtr = NULL;
+
+	linkPtr = &statePtr->subscribers.head;
+	while (*linkPtr != NULL) {
+		linkPtr = &(*linkPtr)->nextPtr;
+	}
+	*linkPtr = subPtr;
+
+	return TCL_OK;
+}
+
+/*
+ * Removes the subscriber registered with exactly the same arguments.
+ * Does nothing if there's no such subscriber.
+ */
+int
+Winpm_Unsubscribe (
+	Tcl_Interp *interp,
+	int eventMask,
+	Winpm_EventProc *proc,
+	ClientData clientData
+	)
+{
+	Winpm_InterpData *statePtr;
+	Winpm_Subscriber *subPtr;
+
+	statePtr = Winpm_GetInterpData(interp);
+	if (statePtr == NULL) return TCL_ERROR;
+
+	eventMask &= WINPM_ALL_EVENTS;
+	for (subPtr = statePtr->subscribers.head; subPtr;
+			subPtr = subPtr->nextPtr) {
+		if (subPtr->proc == proc && subPtr->clientData == clientData
+				&& subPtr->eventMask == eventMask) {
+			subPtr->proc = NULL;
+			statePtr->subscribers.deleted = 1;
+			Winpm_ReleaseMonitor(statePtr);
+			break;
+		}
+	}
+
+	if (statePtr->subscribers.depth == 0
+			&& statePtr->subscribers.deleted) {
+		SweepSubscribers(statePtr);
+	}
+
+	return TCL_OK;
+}
+
+/*
+ * Subscriber used by [winpm _subscribe] to test the delivery: records
+ * the type and changed power fields of each event it gets in the
+ * global "winpm_events" list and denies query events while the global
+ * "winpm_deny" variable is set to true.
+ */
+static int
+TestSubscriber (
+	ClientData clientData,
+	CONST Winpm_Event *eventPtr
+	)
+{
+	Winpm_InterpData *statePtr = (Winpm_InterpData *) clientData;
+	Tcl_Interp *interp = statePtr->interp;
+	Tcl_Obj *elems[2], *denyObj;
+	int deny;
+
+	elems[0] = Tcl_NewIntObj(eventPtr->type);
+	elems[1] = Tcl_NewIntObj(eventPtr->power.changed);
+	Tcl_SetVar2Ex(interp, "winpm_events", NULL, Tcl_NewListObj(2, elems),
+			TCL_GLOBAL_ONLY | TCL_APPEND_VALUE | TCL_LIST_ELEMENT);
+
+	denyObj = Tcl_GetVar2Ex(interp, "winpm_deny", NULL, TCL_GLOBAL_ONLY);
+	if (denyObj != NULL
+			&& Tcl_GetBooleanFromObj(NULL, denyObj, &deny) == TCL_OK
+			&& deny) {
+		return TCL_CONTINUE;
+	}
+	return TCL_OK;
+}
+
+/* winpm _subscribe mask */
+int
+Winpm_CmdSubscribe (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Winpm_Subscriber *subPtr;
+	int mask;
+
+	if (objc != 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "mask");
+		return TCL_ERROR;
+	}
+	if (Tcl_GetIntFromObj(interp, objv[2], &mask) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	for (subPtr = statePtr->subscribers.head; subPtr;
+			subPtr = subPtr->nextPtr) {
+		if (subPtr->proc == TestSubscriber) {
+			Winpm_Unsubscribe(interp, subPtr->eventMask,
+					TestSubscriber, (ClientData) statePtr);
+			break;
+		}
+	}
+
+	if (mask != 0) {
+		return Winpm_Subscribe(interp, mask,
+				TestSubscriber, (ClientData) statePtr);
+	}
+	return TCL_OK;
+}
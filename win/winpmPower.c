@@ -0,0 +1,292 @@
+/*
+ * winpmPower.c --
+ *   Tracking of the system power status.
+ *
+ *   The status as of the last PBT_APMPOWERSTATUSCHANGE is kept so that
+ *   each new notification can be turned into a set of fields which have
+ *   actually changed. Scripts bound with the -on option are only run if
+ *   some of the fields they're interested in are among them.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+/* Names of the fields, in order of their bits */
+static const char *PowerFields[] = {
+	"ac", "battery", "percent", "lifetime", NULL
+};
+
+/*
+ * Gets the current power status: the one set using [winpm _power set],
+ * the one published by another process if attached to it, or the real
+ * one.
+ */
+BOOL
+Winpm_GetPowerStatus (
+	Winpm_InterpData *statePtr,
+	SYSTEM_POWER_STATUS *statusPtr
+	)
+{
+	if (statePtr->power.simulate) {
+		*statusPtr = statePtr->power.simulated;
+		return TRUE;
+	} else if (Winpm_ReadSharedPower(statePtr, statusPtr)) {
+		return TRUE;
+	} else {
+		return GetSystemPowerStatus(statusPtr);
+	}
+}
+
+void
+Winpm_InitPower (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->power.simulate = 0;
+	statePtr->power.valid = Winpm_GetPowerStatus(statePtr,
+			&statePtr->power.snapshot);
+}
+
+/*
+ * Takes a new snapshot of the power status and returns the mask of
+ * WINPM_POWER_* bits for the fields which differ from the previous one,
+ * or -1 if the status can't be obtained.
+ */
+int
+Winpm_UpdatePowerSnapshot (
+	Winpm_InterpData *statePtr
+	)
+{
+	SYSTEM_POWER_STATUS now;
+
+	if (!Winpm_GetPowerStatus(statePtr, &now)) {
+		return -1;
+	}
+
+	return Winpm_SetPowerSnapshot(statePtr, &now);
+}
+
+/*
+ * Makes the status the snapshot, as a client does with the one relayed
+ * by its broker, and returns the mask of the fields which differ from
+ * the previous one.
+ */
+int
+Winpm_SetPowerSnapshot (
+	Winpm_InterpData *statePtr,
+	CONST SYSTEM_POWER_STATUS *nowPtr
+	)
+{
+	SYSTEM_POWER_STATUS *prevPtr;
+	int changed;
+
+	prevPtr = &statePtr->power.snapshot;
+	if (!statePtr->power.valid) {
+		changed = WINPM_POWER_ALL;
+	} else {
+		changed = 0;
+		if (nowPtr->ACLineStatus != prevPtr->ACLineStatus) {
+			changed |= WINPM_POWER_AC;
+		}
+		if (nowPtr->BatteryFlag != prevPtr->BatteryFlag) {
+			changed |= WINPM_POWER_BATTERY;
+		}
+		if (nowPtr->BatteryLifePercent != prevPtr->BatteryLifePercent) {
+			changed |= WINPM_POWER_PERCENT;
+		}
+		if (nowPtr->BatteryLifeTime != prevPtr->BatteryLifeTime) {
+			changed |= WINPM_POWER_LIFETIME;
+		}
+	}
+
+	*prevPtr = *nowPtr;
+	statePtr->power.valid = 1;
+
+	return changed;
+}
+
+CONST char *
+Winpm_ACLineStatusName (
+	BYTE status
+	)
+{
+	switch (status) {
+		case 0:
+			return "OFFLINE";
+		case 1:
+			return "ONLINE";
+		default:
+			return "UNKNOWN";
+	}
+}
+
+CONST char *
+Winpm_BatteryFlagName (
+	BYTE flag
+	)
+{
+	switch (flag) {
+		case 1:
+			return "HIGH";
+		case 2:
+			return "LOW";
+		case 4:
+			return "CRITICAL";
+		case 8:
+			return "CHARGING";
+		case 128:
+			return "NONE";
+		default:
+			return "UNKNOWN";
+	}
+}
+
+int
+Winpm_BatteryPercent (
+	BYTE percent
+	)
+{
+	return percent == 255 ? -1 : percent;
+}
+
+/* Returns the status in the form [winpm info power] reports it */
+Tcl_Obj *
+Winpm_NewPowerStatusObj (
+	CONST SYSTEM_POWER_STATUS *statusPtr
+	)
+{
+	Tcl_Obj *elems[5];
+
+	elems[0] = Tcl_NewStringObj(
+			Winpm_ACLineStatusName(statusPtr->ACLineStatus), -1);
+	elems[1] = Tcl_NewStringObj(
+			Winpm_BatteryFlagName(statusPtr->BatteryFlag), -1);
+	elems[2] = Tcl_NewIntObj(
+			Winpm_BatteryPercent(statusPtr->BatteryLifePercent));
+	elems[3] = Tcl_NewIntObj(statusPtr->BatteryLifeTime);
+	elems[4] = Tcl_NewIntObj(statusPtr->BatteryFullLifeTime);
+
+	return Tcl_NewListObj(5, elems);
+}
+
+/*
+ * Parses a list of field names into the mask of WINPM_POWER_* bits.
+ */
+int
+Winpm_GetPowerFieldsFromObj (
+	Tcl_Interp *interp,
+	Tcl_Obj *objPtr,
+	int *fieldsPtr
+	)
+{
+	Tcl_Obj **elems;
+	int i, n, field, fields;
+
+	if (Tcl_ListObjGetElements(interp, objPtr, &n, &elems) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	fields = 0;
+	for (i = 0; i < n; ++i) {
+		if (Tcl_GetIndexFromObj(interp, elems[i], PowerFields, "field",
+				0, &field) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		fields |= 1 << field;
+	}
+
+	*fieldsPtr = fields;
+	return TCL_OK;
+}
+
+Tcl_Obj *
+Winpm_NewPowerFieldsObj (
+	int fields
+	)
+{
+	Tcl_Obj *listObj;
+	int i;
+
+	listObj = Tcl_NewListObj(0, NULL);
+	for (i = 0; PowerFields[i] != NULL; ++i) {
+		if (fields & (1 << i)) {
+			Tcl_ListObjAppendElement(NULL, listObj,
+					Tcl_NewStringObj(PowerFields[i], -1));
+		}
+	}
+
+	return listObj;
+}
+
+/*
+ * winpm _power set ac battery percent lifetime
+ * winpm _power reset
+ */
+int
+Winpm_CmdPower (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *actions[] = { "set", "reset", NULL };
+	typedef enum { PWR_SET, PWR_RESET } PWR_Action;
+	int act;
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "action ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], actions, "action",
+			0, &act) != TCL_OK) { return TCL_ERROR; }
+
+	switch (act) {
+		case PWR_SET: {
+			SYSTEM_POWER_STATUS status;
+			int ac, flag, percent, lifetime;
+
+			if (objc != 7) {
+				Tcl_WrongNumArgs(interp, 3, objv,
+						"ac battery percent lifetime");
+				return TCL_ERROR;
+			}
+			if (Tcl_GetIntFromObj(interp, objv[3], &ac) != TCL_OK
+					|| Tcl_GetIntFromObj(interp, objv[4], &flag) != TCL_OK
+					|| Tcl_GetIntFromObj(interp, objv[5], &percent) != TCL_OK
+					|| Tcl_GetIntFromObj(interp, objv[6], &lifetime) != TCL_OK) {
+				return TCL_ERROR;
+			}
+
+			memset(&status, 0, sizeof(status));
+			status.ACLineStatus = (BYTE) ac;
+			status.BatteryFlag = (BYTE) flag;
+			status.BatteryLifePercent = (BYTE) percent;
+			status.BatteryLifeTime = (DWORD) lifetime;
+			status.BatteryFullLifeTime = (DWORD) -1;
+
+			statePtr->power.simulated = status;
+			statePtr->power.simulate = 1;
+			Winpm_PublishPower(statePtr);
+		}
+		break;
+
+		case PWR_RESET:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			statePtr->power.simulate = 0;
+			Winpm_PublishPower(statePtr);
+		break;
+	}
+
+	return TCL_OK;
+}
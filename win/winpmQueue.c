@@ -0,0 +1,317 @@
+/*
+ * winpmQueue.c --
+ *   Priority-ordered queue of messages received by the monitoring window.
+ *
+ *   A message arriving while the interpreter is still busy with the
+ *   scripts bound to the previous one (for instance, a script has
+ *   entered the event loop using [update] or [vwait]) is not processed
+ *   recursively but waits for its turn. Messages the system expects an
+ *   immediate answer to or which precede the process being suspended or
+ *   terminated can't wait, so they bypass the queue and thus overtake
+ *   anything pending. The rest is processed in order of priority, and
+ *   a status change notification or a timer tick supersedes the one
+ *   still pending.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+typedef enum {
+	PRIO_LOW,
+	PRIO_NORMAL,
+	PRIO_HIGH,
+	PRIO_URGENT /* Never queued */
+} Priority;
+
+struct Winpm_QueuedMessage {
+	UINT uMsg;
+	WPARAM wParam;
+	LPARAM lParam;
+	Priority priority;
+	char *dataPtr; /* Copy of the data lParam points to, if any */
+	Winpm_QueuedMessage *nextPtr;
+};
+
+static Priority
+MessagePriority (
+	UINT uMsg,
+	WPARAM wParam
+	)
+{
+	switch (uMsg) {
+		case WM_QUERYENDSESSION:
+		case WM_ENDSESSION:
+			return PRIO_URGENT;
+		break;
+
+		case WM_POWERBROADCAST:
+			switch (wParam) {
+				case PBT_APMQUERYSUSPEND:
+				case PBT_APMSUSPEND:
+					return PRIO_URGENT;
+				break;
+
+				case PBT_APMRESUMEAUTOMATIC:
+				case PBT_APMRESUMESUSPEND:
+				case PBT_APMRESUMECRITICAL:
+				case PBT_APMQUERYSUSPENDFAILED:
+				case PBT_APMBATTERYLOW:
+					return PRIO_HIGH;
+				break;
+
+				case PBT_APMPOWERSTATUSCHANGE:
+					return PRIO_LOW;
+				break;
+			}
+		break;
+
+		case WM_TIMER:
+			return PRIO_LOW;
+		break;
+	}
+
+	return PRIO_NORMAL;
+}
+
+static void
+FreeMessage (
+	Winpm_QueuedMessage *msgPtr
+	)
+{
+	if (msgPtr->dataPtr != NULL) {
+		ckfree(msgPtr->dataPtr);
+	}
+	ckfree((char *) msgPtr);
+}
+
+static int
+IsStatusChange (
+	Winpm_QueuedMessage *msgPtr
+	)
+{
+	return msgPtr->uMsg == WM_POWERBROADCAST
+		&& msgPtr->wParam == PBT_APMPOWERSTATUSCHANGE;
+}
+
+/* Returns true if the new message makes the pending one pointless */
+static int
+Supersedes (
+	Winpm_QueuedMessage *newPtr,
+	Winpm_QueuedMessage *oldPtr
+	)
+{
+	if (IsStatusChange(newPtr) && IsStatusChange(oldPtr)) return 1;
+	return newPtr->uMsg == WM_TIMER && oldPtr->uMsg == WM_TIMER
+		&& newPtr->wParam == oldPtr->wParam;
+}
+
+static LRESULT
+ProcessNested (
+	Winpm_InterpData *statePtr,
+	UINT uMsg,
+	WPARAM wParam,
+	LPARAM lParam
+	)
+{
+	LRESULT res;
+
+	++statePtr->queue.depth;
+	res = Winpm_ProcessMessage(statePtr, uMsg, wParam, lParam);
+	--statePtr->queue.depth;
+
+	return res;
+}
+
+/*
+ * Processes pending messages, most important first, until the queue
+ * is empty. Does nothing if called while some message is being
+ * processed: the outermost caller will get to the pending ones.
+ */
+static void
+DrainQueue (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_QueuedMessage *msgPtr;
+
+	if (statePtr->queue.depth > 0) return;
+
+	while (!statePtr->queue.held && statePtr->queue.head != NULL) {
+		msgPtr = statePtr->queue.head;
+		statePtr->queue.head = msgPtr->nextPtr;
+
+		ProcessNested(statePtr, msgPtr->uMsg,
+				msgPtr->wParam, msgPtr->lParam);
+		FreeMessage(msgPtr);
+	}
+}
+
+/*
+ * Entry point for the messages received by the monitoring window.
+ * Returns the value the window procedure should return.
+ */
+LRESULT
+Winpm_QueueMessage (
+	Winpm_InterpData *statePtr,
+	UINT uMsg,
+	WPARAM wParam,
+	LPARAM lParam
+	)
+{
+	Winpm_QueuedMessage *msgPtr, **linkPtr;
+	Priority priority;
+
+	priority = MessagePriority(uMsg, wParam);
+
+	if (priority == PRIO_URGENT) {
+		LRESULT res;
+
+		res = ProcessNested(statePtr, uMsg, wParam, lParam);
+		DrainQueue(statePtr);
+		return res;
+	}
+
+	msgPtr = (Winpm_QueuedMessage *) ckalloc(sizeof(Winpm_QueuedMessage));
+	msgPtr->uMsg = uMsg;
+	msgPtr->wParam = wParam;
+	msgPtr->lParam = lParam;
+	msgPtr->priority = priority;
+	msgPtr->dataPtr = NULL;
+	msgPtr->nextPtr = NULL;
+
+	if (uMsg == WM_POWERBROADCAST && wParam == PBT_POWERSETTINGCHANGE
+			&& lParam != 0) {
+		/* The setting data is only valid until we return */
+		POWERBROADCAST_SETTING *settingPtr;
+		size_t size;
+
+		settingPtr = (POWERBROADCAST_SETTING *) lParam;
+		size = offsetof(POWERBROADCAST_SETTING, Data)
+			+ settingPtr->DataLength;
+		msgPtr->dataPtr = ckalloc(size);
+		memcpy(msgPtr->dataPtr, settingPtr, size);
+		msgPtr->lParam = (LPARAM) msgPtr->dataPtr;
+	}
+
+	linkPtr = &statePtr->queue.head;
+	while (*linkPtr != NULL) {
+		if (Supersedes(msgPtr, *linkPtr)) {
+			(*linkPtr)->lParam = lParam;
+			++statePtr->queue.merged;
+			ckfree((char *) msgPtr);
+			msgPtr = NULL;
+			break;
+		}
+		if ((*linkPtr)->priority < priority) break;
+		linkPtr = &(*linkPtr)->nextPtr;
+	}
+
+	if (msgPtr != NULL) {
+		msgPtr->nextPtr = *linkPtr;
+		*linkPtr = msgPtr;
+	}
+
+	DrainQueue(statePtr);
+
+	/* Only notifications and WM_TIMER are ever queued, and for the
+	 * non-query classes of WM_POWERBROADCAST the answer is always the
+	 * same; the answer to the others is ignored */
+	return TRUE;
+}
+
+void
+Winpm_InitQueue (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->queue.head = NULL;
+	statePtr->queue.depth = 0;
+	statePtr->queue.held = 0;
+	statePtr->queue.merged = 0;
+}
+
+void
+Winpm_FinalizeQueue (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_QueuedMessage *msgPtr, *nextPtr;
+
+	for (msgPtr = statePtr->queue.head; msgPtr; msgPtr = nextPtr) {
+		nextPtr = msgPtr->nextPtr;
+		FreeMessage(msgPtr);
+	}
+	statePtr->queue.head = NULL;
+}
+
+/*
+ * Returns the description of the queue state for [winpm info queue]:
+ * the list of pending messages (each being a list of uMsg, wParam and
+ * lParam) and the number of merged messages.
+ */
+Tcl_Obj *
+Winpm_NewQueueInfoObj (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_QueuedMessage *msgPtr;
+	Tcl_Obj *pendingObj, *elems[4];
+
+	pendingObj = Tcl_NewListObj(0, NULL);
+	for (msgPtr = statePtr->queue.head; msgPtr; msgPtr = msgPtr->nextPtr) {
+		Tcl_Obj *msg[3];
+
+		msg[0] = Tcl_NewLongObj(msgPtr->uMsg);
+		msg[1] = Tcl_NewLongObj(msgPtr->wParam);
+		msg[2] = Tcl_NewLongObj(msgPtr->lParam);
+		Tcl_ListObjAppendElement(NULL, pendingObj, Tcl_NewListObj(3, msg));
+	}
+
+	elems[0] = Tcl_NewStringObj("pending", -1);
+	elems[1] = pendingObj;
+	elems[2] = Tcl_NewStringObj("merged", -1);
+	elems[3] = Tcl_NewLongObj(statePtr->queue.merged);
+
+	return Tcl_NewListObj(4, elems);
+}
+
+/* winpm _queue hold|release */
+int
+Winpm_CmdQueue (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *actions[] = { "hold", "release", NULL };
+	typedef enum { QUE_HOLD, QUE_RELEASE } QUE_Action;
+	int act;
+
+	if (objc != 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "hold|release");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], actions, "action",
+			0, &act) != TCL_OK) { return TCL_ERROR; }
+
+	switch (act) {
+		case QUE_HOLD:
+			statePtr->queue.held = 1;
+		break;
+
+		case QUE_RELEASE:
+			statePtr->queue.held = 0;
+			DrainQueue(statePtr);
+		break;
+	}
+
+	return TCL_OK;
+}
@@ -0,0 +1,403 @@
+/*
+ * winpmSchedule.c --
+ *   Power-aware scheduler of background jobs.
+ *
+ *   A job is a script run periodically from the Tcl timer queue. Its
+ *   cadence follows the power snapshot: on AC power (or if the power
+ *   source is unknown) the job runs at its full rate, on battery its
+ *   period is stretched according to its duty cycle, and below its
+ *   battery level the job isn't run at all. The mode of each job is
+ *   reconsidered on every power status change.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+#include <limits.h>
+
+typedef enum {
+	MODE_AC,
+	MODE_BATTERY,
+	MODE_PAUSED
+} Mode;
+
+static const char *ModeNames[] = { "ac", "battery", "paused" };
+
+typedef struct {
+	Winpm_InterpData *statePtr;
+	Tcl_HashEntry *entryPtr; /* NULL once the job is removed */
+	Tcl_Obj *scriptObj;
+	Tcl_WideInt interval; /* Period on AC power, usecs */
+	int duty; /* Percents of the full rate on battery */
+	int pause; /* Battery level the job is paused below, 0 = never */
+	Mode mode;
+	Tcl_TimerToken timer; /* NULL if not armed */
+	int running; /* Set while the script is being run */
+	long runs;
+	long errors;
+} Job;
+
+static const char *JobOptions[] = { "-interval", "-battery", "-pause", NULL };
+typedef enum { JOPT_INTERVAL, JOPT_BATTERY, JOPT_PAUSE } JOPT_Option;
+
+static void RunJob (ClientData clientData);
+
+void
+Winpm_InitSchedule (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_InitHashTable(&statePtr->schedule.jobs, TCL_STRING_KEYS);
+}
+
+static void
+FreeJob (
+	char *blockPtr
+	)
+{
+	Job *jobPtr = (Job *) blockPtr;
+
+	Tcl_DecrRefCount(jobPtr->scriptObj);
+	ckfree((char *) jobPtr);
+}
+
+static void
+RemoveJob (
+	Job *jobPtr
+	)
+{
+	if (jobPtr->timer != NULL) {
+		Tcl_DeleteTimerHandler(jobPtr->timer);
+		jobPtr->timer = NULL;
+	}
+	Tcl_DeleteHashEntry(jobPtr->entryPtr);
+	jobPtr->entryPtr = NULL;
+	Tcl_EventuallyFree((ClientData) jobPtr, FreeJob);
+}
+
+void
+Winpm_FinalizeSchedule (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_HashEntry *entryPtr;
+	Tcl_HashSearch search;
+
+	entryPtr = Tcl_FirstHashEntry(&statePtr->schedule.jobs, &search);
+	while (entryPtr != NULL) {
+		RemoveJob((Job *) Tcl_GetHashValue(entryPtr));
+		entryPtr = Tcl_NextHashEntry(&search);
+	}
+	Tcl_DeleteHashTable(&statePtr->schedule.jobs);
+}
+
+/* Decides how the job should run according to the power snapshot */
+static Mode
+CurrentMode (
+	Job *jobPtr
+	)
+{
+	Winpm_InterpData *statePtr = jobPtr->statePtr;
+	SYSTEM_POWER_STATUS *statusPtr = &statePtr->power.snapshot;
+	int percent;
+
+	if (!statePtr->power.valid || statusPtr->ACLineStatus != 0) {
+		return MODE_AC;
+	}
+
+	percent = Winpm_BatteryPercent(statusPtr->BatteryLifePercent);
+	if (jobPtr->pause > 0 && percent != -1 && percent < jobPtr->pause) {
+		return MODE_PAUSED;
+	}
+	return MODE_BATTERY;
+}
+
+/* Arms the timer of the job for its next run, if it's not paused */
+static void
+ArmJob (
+	Job *jobPtr
+	)
+{
+	Tcl_WideInt usec;
+
+	if (jobPtr->timer != NULL) {
+		Tcl_DeleteTimerHandler(jobPtr->timer);
+		jobPtr->timer = NULL;
+	}
+
+	jobPtr->mode = CurrentMode(jobPtr);
+	if (jobPtr->mode == MODE_PAUSED) return;
+
+	usec = jobPtr->interval;
+	if (jobPtr->mode == MODE_BATTERY) {
+		usec = usec * 100 / jobPtr->duty;
+	}
+	/* Stretched periods may well be beyond what the timer takes */
+	if (usec / 1000 > INT_MAX) usec = (Tcl_WideInt) INT_MAX * 1000;
+	jobPtr->timer = Tcl_CreateTimerHandler((int) (usec / 1000),
+			RunJob, (ClientData) jobPtr);
+}
+
+static void
+RunJob (
+	ClientData clientData
+	)
+{
+	Job *jobPtr = (Job *) clientData;
+	Tcl_Interp *interp = jobPtr->statePtr->interp;
+	int code;
+
+	jobPtr->timer = NULL;
+
+	/* The script is free to remove or replace its job */
+	Tcl_Preserve((ClientData) jobPtr);
+	Tcl_Preserve((ClientData) interp);
+	jobPtr->running = 1;
+
+	++jobPtr->runs;
+	code = Tcl_EvalObjEx(interp, jobPtr->scriptObj, TCL_EVAL_GLOBAL);
+	if (code == TCL_ERROR) {
+		++jobPtr->errors;
+		Tcl_AddErrorInfo(interp, "\n    (" PACKAGE_NAME " scheduled job \"");
+		if (jobPtr->entryPtr != NULL) {
+			Tcl_AddErrorInfo(interp, Tcl_GetHashKey(
+					&jobPtr->statePtr->schedule.jobs, jobPtr->entryPtr));
+		}
+		Tcl_AddErrorInfo(interp, "\")");
+		Tcl_BackgroundError(interp);
+	}
+
+	jobPtr->running = 0;
+	if (jobPtr->entryPtr != NULL && jobPtr->timer == NULL) {
+		ArmJob(jobPtr);
+	}
+
+	Tcl_Release((ClientData) interp);
+	Tcl_Release((ClientData) jobPtr);
+}
+
+/*
+ * Reconsiders the mode of each job. Called when the power snapshot
+ * changes. Jobs which keep their mode keep their cadence.
+ */
+void
+Winpm_RescheduleJobs (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_HashEntry *entryPtr;
+	Tcl_HashSearch search;
+	Job *jobPtr;
+
+	entryPtr = Tcl_FirstHashEntry(&statePtr->schedule.jobs, &search);
+	while (entryPtr != NULL) {
+		jobPtr = (Job *) Tcl_GetHashValue(entryPtr);
+		if (!jobPtr->running && CurrentMode(jobPtr) != jobPtr->mode) {
+			ArmJob(jobPtr);
+		}
+		entryPtr = Tcl_NextHashEntry(&search);
+	}
+}
+
+static Tcl_Obj *
+NewJobInfoObj (
+	Job *jobPtr
+	)
+{
+	Tcl_Obj *elems[14];
+
+	elems[0]  = Tcl_NewStringObj(JobOptions[JOPT_INTERVAL], -1);
+	elems[1]  = Winpm_NewIntervalObj(jobPtr->interval);
+	elems[2]  = Tcl_NewStringObj(JobOptions[JOPT_BATTERY], -1);
+	elems[3]  = Tcl_NewIntObj(jobPtr->duty);
+	elems[4]  = Tcl_NewStringObj(JobOptions[JOPT_PAUSE], -1);
+	elems[5]  = Tcl_NewIntObj(jobPtr->pause);
+	elems[6]  = Tcl_NewStringObj("mode", -1);
+	elems[7]  = Tcl_NewStringObj(ModeNames[jobPtr->mode], -1);
+	elems[8]  = Tcl_NewStringObj("runs", -1);
+	elems[9]  = Tcl_NewLongObj(jobPtr->runs);
+	elems[10] = Tcl_NewStringObj("errors", -1);
+	elems[11] = Tcl_NewLongObj(jobPtr->errors);
+	elems[12] = Tcl_NewStringObj("script", -1);
+	elems[13] = jobPtr->scriptObj;
+
+	return Tcl_NewListObj(14, elems);
+}
+
+/*
+ * Parses the job options from objv (which must have even objc)
+ * into the job record. Nothing is changed on error.
+ */
+static int
+ConfigureJob (
+	Tcl_Interp *interp,
+	Job *jobPtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Job new;
+	int i, opt, value;
+
+	new = *jobPtr;
+
+	for (i = 0; i < objc; i += 2) {
+		if (Tcl_GetIndexFromObj(interp, objv[i], JobOptions, "option",
+				0, &opt) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		if (opt == JOPT_INTERVAL) {
+			if (Winpm_GetIntervalFromObj(interp, objv[i+1],
+					&new.interval) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			continue;
+		}
+		if (Tcl_GetIntFromObj(interp, objv[i+1], &value) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		if (value < (opt == JOPT_BATTERY ? 1 : 0) || value > 100) {
+			Tcl_AppendResult(interp, "bad value for ", JobOptions[opt],
+					": \"", Tcl_GetString(objv[i+1]), "\"", NULL);
+			return TCL_ERROR;
+		}
+		if (opt == JOPT_BATTERY) {
+			new.duty = value;
+		} else {
+			new.pause = value;
+		}
+	}
+
+	*jobPtr = new;
+	return TCL_OK;
+}
+
+/*
+ * winpm schedule add name ?-option value ...? script
+ * winpm schedule remove name
+ * winpm schedule names
+ * winpm schedule info name
+ */
+int
+Winpm_CmdSchedule (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *subcmds[] = { "add", "info", "names", "remove", NULL };
+	typedef enum { SCH_ADD, SCH_INFO, SCH_NAMES, SCH_REMOVE } SCH_Option;
+	Tcl_HashEntry *entryPtr;
+	Tcl_HashSearch search;
+	Job *jobPtr, new;
+	int opt, isNew;
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "subcommand ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], subcmds, "subcommand",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	switch (opt) {
+		case SCH_ADD:
+			if (objc < 5 || objc % 2 == 0) {
+				Tcl_WrongNumArgs(interp, 3, objv,
+						"name ?-option value ...? script");
+				return TCL_ERROR;
+			}
+
+			memset(&new, 0, sizeof(new));
+			new.statePtr = statePtr;
+			new.interval = WINPM_JOB_INTERVAL;
+			new.duty = 100;
+			if (ConfigureJob(interp, &new, objc - 5, objv + 4) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			if (new.interval < 1000) {
+				Tcl_SetResult(interp, "bad value for -interval: "
+						"must be at least 1ms", TCL_STATIC);
+				return TCL_ERROR;
+			}
+
+			entryPtr = Tcl_FindHashEntry(&statePtr->schedule.jobs,
+					Tcl_GetString(objv[3]));
+			if (entryPtr != NULL) {
+				/* Replacing a job doesn't reset its statistics */
+				jobPtr = (Job *) Tcl_GetHashValue(entryPtr);
+				new.runs = jobPtr->runs;
+				new.errors = jobPtr->errors;
+				RemoveJob(jobPtr);
+			} else if (Winpm_HoldMonitor(statePtr) != TCL_OK) {
+				/* Jobs follow the power status changes */
+				return TCL_ERROR;
+			}
+
+			new.scriptObj = objv[objc-1];
+			Tcl_IncrRefCount(new.scriptObj);
+
+			jobPtr = (Job *) ckalloc(sizeof(Job));
+			*jobPtr = new;
+			jobPtr->entryPtr = Tcl_CreateHashEntry(&statePtr->schedule.jobs,
+					Tcl_GetString(objv[3]), &isNew);
+			Tcl_SetHashValue(jobPtr->entryPtr, (ClientData) jobPtr);
+			ArmJob(jobPtr);
+			return TCL_OK;
+		break;
+
+		case SCH_INFO:
+		case SCH_REMOVE:
+			if (objc != 4) {
+				Tcl_WrongNumArgs(interp, 3, objv, "name");
+				return TCL_ERROR;
+			}
+
+			entryPtr = Tcl_FindHashEntry(&statePtr->schedule.jobs,
+					Tcl_GetString(objv[3]));
+			if (entryPtr == NULL) {
+				Tcl_AppendResult(interp, "no such job \"",
+						Tcl_GetString(objv[3]), "\"", NULL);
+				return TCL_ERROR;
+			}
+
+			jobPtr = (Job *) Tcl_GetHashValue(entryPtr);
+			if (opt == SCH_INFO) {
+				Tcl_SetObjResult(interp, NewJobInfoObj(jobPtr));
+			} else {
+				RemoveJob(jobPtr);
+				Winpm_ReleaseMonitor(statePtr);
+			}
+			return TCL_OK;
+		break;
+
+		case SCH_NAMES: {
+			Tcl_Obj *listObj;
+
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+
+			listObj = Tcl_NewListObj(0, NULL);
+			entryPtr = Tcl_FirstHashEntry(&statePtr->schedule.jobs, &search);
+			while (entryPtr != NULL) {
+				Tcl_ListObjAppendElement(interp, listObj, Tcl_NewStringObj(
+						Tcl_GetHashKey(&statePtr->schedule.jobs,
+							entryPtr), -1));
+				entryPtr = Tcl_NextHashEntry(&search);
+			}
+			Tcl_SetObjResult(interp, listObj);
+			return TCL_OK;
+		}
+		break;
+	}
+
+	return TCL_OK;
+}
@@ -0,0 +1,181 @@
+/*
+ * winpmSession.c --
+ *   Session lock, unlock and switch events.
+ *
+ *   The monitoring window registers for the session change
+ *   notifications of Terminal Services (WM_WTSSESSION_CHANGE), which
+ *   also cover the console of a workstation: locking it, unlocking it
+ *   and switching users. Locking and unlocking are reported as the
+ *   SESSION_LOCK and SESSION_UNLOCK events, the session being
+ *   connected to or disconnected from the console or a remote terminal
+ *   (which is what a fast user switch is) and logging on and off as
+ *   SESSION_SWITCH. The functions of wtsapi32.dll are looked up at
+ *   runtime since the library is missing before Windows XP.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+#ifndef NOTIFY_FOR_THIS_SESSION
+#define NOTIFY_FOR_THIS_SESSION 0
+#endif
+
+/* Reasons of the session changes, as in WTS_* */
+#define CHANGE_LOCK   7
+#define CHANGE_UNLOCK 8
+
+static Winpm_EventType SessionEvents[] = {
+	{ "SESSION_LOCK",   WINPM_SESSIONLOCK },
+	{ "SESSION_UNLOCK", WINPM_SESSIONUNLOCK },
+	{ "SESSION_SWITCH", WINPM_SESSIONSWITCH },
+	{ NULL }
+};
+typedef enum { EV_LOCK, EV_UNLOCK, EV_SWITCH } EV_Session;
+
+/* Names of the reasons of SESSION_SWITCH, indexed by WTS_* codes */
+static CONST char *Reasons[] = {
+	NULL,
+	"CONSOLE_CONNECT",
+	"CONSOLE_DISCONNECT",
+	"REMOTE_CONNECT",
+	"REMOTE_DISCONNECT",
+	"LOGON",
+	"LOGOFF",
+};
+
+typedef BOOL (WINAPI *RegisterSessionProc) (HWND, DWORD);
+typedef BOOL (WINAPI *UnregisterSessionProc) (HWND);
+
+TCL_DECLARE_MUTEX(wtsMutex);
+
+static struct {
+	RegisterSessionProc registerProc;
+	UnregisterSessionProc unregisterProc;
+} Wts;
+
+void
+Winpm_InitSession (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_RegisterEvents(SessionEvents);
+}
+
+/*
+ * Loads wtsapi32.dll, if not yet loaded. The library is never unloaded
+ * since other interpreters may be using it. Returns 0 on failure.
+ */
+static int
+LoadWts (void)
+{
+	static int loaded = 0;
+	HMODULE hmod;
+
+	if (loaded) return loaded > 0;
+
+	Tcl_MutexLock(&wtsMutex);
+	if (loaded == 0) {
+		loaded = -1;
+		hmod = LoadLibrary(_T("wtsapi32.dll"));
+		if (hmod != NULL) {
+			Wts.registerProc = (RegisterSessionProc)
+				GetProcAddress(hmod, "WTSRegisterSessionNotification");
+			Wts.unregisterProc = (UnregisterSessionProc)
+				GetProcAddress(hmod, "WTSUnRegisterSessionNotification");
+			if (Wts.registerProc != NULL && Wts.unregisterProc != NULL) {
+				loaded = 1;
+			}
+		}
+	}
+	Tcl_MutexUnlock(&wtsMutex);
+
+	return loaded > 0;
+}
+
+/*
+ * Registers the monitoring window for the session change notifications.
+ * Fails quietly if the Terminal Services aren't running (yet), in which
+ * case the session events are never fired.
+ */
+void
+Winpm_RegisterSession (
+	Winpm_InterpData *statePtr
+	)
+{
+	if (!LoadWts()) return;
+	Wts.registerProc(statePtr->hwndMonitor, NOTIFY_FOR_THIS_SESSION);
+}
+
+void
+Winpm_UnregisterSession (
+	Winpm_InterpData *statePtr
+	)
+{
+	if (!LoadWts()) return;
+	Wts.unregisterProc(statePtr->hwndMonitor);
+}
+
+/* Fires the event the session change notification represents, if any */
+void
+Winpm_ProcessSessionChange (
+	Winpm_InterpData *statePtr,
+	WPARAM wParam,
+	LPARAM lParam
+	)
+{
+	Winpm_Event event;
+	Winpm_PercentMap map[3];
+	char id[TCL_INTEGER_SPACE];
+	Winpm_EventType *typePtr;
+
+	memset(&event, 0, sizeof(event));
+	event.power.changed = -1;
+	event.wts.reason = (int) wParam;
+	event.wts.id = (unsigned long) lParam;
+
+	sprintf(id, "%lu", event.wts.id);
+	map[0].token = 'i';
+	map[0].value = id;
+	map[1].token = '\0';
+
+	switch (wParam) {
+		case CHANGE_LOCK:
+			typePtr = &SessionEvents[EV_LOCK];
+		break;
+
+		case CHANGE_UNLOCK:
+			typePtr = &SessionEvents[EV_UNLOCK];
+		break;
+
+		default:
+			if (wParam == 0 || wParam >= sizeof(Reasons)/sizeof(Reasons[0])) {
+				return;
+			}
+			typePtr = &SessionEvents[EV_SWITCH];
+			map[1].token = 'r';
+			map[1].value = Winpm_SessionReasonName((int) wParam);
+			map[2].token = '\0';
+		break;
+	}
+
+	event.type = typePtr->type;
+	Winpm_FireEvent(statePtr, &event, map, typePtr);
+}
+
+/* Returns the name of the reason of SESSION_SWITCH */
+CONST char *
+Winpm_SessionReasonName (
+	int reason
+	)
+{
+	if (reason <= 0 || reason >= sizeof(Reasons)/sizeof(Reasons[0])) {
+		return "UNKNOWN";
+	}
+	return Reasons[reason];
+}
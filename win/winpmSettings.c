@@ -0,0 +1,492 @@
+/*
+ * winpmSettings.c --
+ *   Power setting change notifications (Windows Vista and later).
+ *
+ *   The monitoring window registers for the changes of a few power
+ *   settings using RegisterPowerSettingNotification() and gets them as
+ *   the PBT_POWERSETTINGCHANGE class of WM_POWERBROADCAST. The system
+ *   sends the current value of each setting right upon registration,
+ *   so the last values received are kept and reported without asking
+ *   the system again. On older systems no notifications arrive and the
+ *   values stay unknown. While the window doesn't exist the system is
+ *   asked when the profile is requested.
+ *
+ *   The state of the lid and the source of power are reported as events
+ *   of their own, LID_CLOSE, LID_OPEN and POWER_SOURCE, but only when
+ *   they change: the values sent upon registration are just remembered.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+#ifndef DEVICE_NOTIFY_WINDOW_HANDLE
+#define DEVICE_NOTIFY_WINDOW_HANDLE 0
+#endif
+
+/* Looked up at runtime since they're missing before Vista */
+typedef PVOID (WINAPI *RegisterNotificationProc) (HANDLE, LPCGUID, DWORD);
+typedef BOOL (WINAPI *UnregisterNotificationProc) (PVOID);
+typedef DWORD (WINAPI *GetActiveSchemeProc) (HKEY, GUID **);
+
+TCL_DECLARE_MUTEX(powrprofMutex);
+
+static GetActiveSchemeProc getActiveSchemeProc;
+
+/* Layout of SYSTEM_POWER_STATUS, whose fourth byte is the state of
+ * the energy saver on Windows 10 but is named Reserved1 in older SDKs */
+typedef struct {
+	BYTE acLine;
+	BYTE batteryFlag;
+	BYTE batteryPercent;
+	BYTE statusFlag;
+	DWORD batteryLifeTime;
+	DWORD batteryFullLifeTime;
+} PowerStatus;
+
+/* GUID_POWERSCHEME_PERSONALITY */
+static const GUID GuidPersonality = { 0x245d8541, 0x3943, 0x4422,
+	{ 0xb0, 0x25, 0x13, 0xa7, 0x84, 0xf6, 0x79, 0xb7 } };
+/* GUID_POWER_SAVING_STATUS */
+static const GUID GuidPowerSaving = { 0xe00958c0, 0xc213, 0x4ace,
+	{ 0xac, 0x77, 0xfe, 0xcc, 0xed, 0x2e, 0xee, 0xa5 } };
+/* GUID_LIDSWITCH_STATE_CHANGE */
+static const GUID GuidLidSwitch = { 0xba3e0f4d, 0xb817, 0x4094,
+	{ 0xa2, 0xd1, 0xd5, 0x63, 0x79, 0xe6, 0xa0, 0xf3 } };
+/* GUID_ACDC_POWER_SOURCE */
+static const GUID GuidPowerSource = { 0x5d3e9a59, 0xe9d5, 0x4b00,
+	{ 0xa6, 0xbd, 0xff, 0x34, 0xff, 0x51, 0x65, 0x48 } };
+
+/* Sources of power, indexed by WINPM_SOURCE_* */
+static const char *Sources[] = { "AC", "DC", "UPS", NULL };
+
+/* Personalities of power schemes, indexed by WINPM_PROFILE_* */
+static const struct {
+	CONST char *name;
+	GUID guid;
+} Personalities[] = {
+	{ "unknown", { 0, 0, 0, { 0, 0, 0, 0, 0, 0, 0, 0 } } },
+	/* GUID_MAX_POWER_SAVINGS */
+	{ "power-saver", { 0xa1841308, 0x3541, 0x4fab,
+		{ 0xbc, 0x81, 0xf7, 0x15, 0x56, 0xf2, 0x0b, 0x4a } } },
+	/* GUID_TYPICAL_POWER_SAVINGS */
+	{ "balanced", { 0x381b4222, 0xf694, 0x41f0,
+		{ 0x96, 0x85, 0xff, 0x5b, 0xb2, 0x60, 0xdf, 0x2e } } },
+	/* GUID_MIN_POWER_SAVINGS */
+	{ "performance", { 0x8c5e7fda, 0xe8bf, 0x4a96,
+		{ 0x9a, 0x85, 0xa6, 0xe2, 0x3a, 0x8c, 0x63, 0x5c } } },
+};
+
+/* Events of the settings. The lid and the source of power are events
+ * on their own, the rest is fired along with PBT_POWERSETTINGCHANGE */
+static Winpm_EventType SettingEvents[] = {
+	{ "GUID_POWERSCHEME_PERSONALITY" },
+	{ "GUID_POWER_SAVING_STATUS" },
+	{ "LID_CLOSE",    WINPM_LIDCLOSE },
+	{ "LID_OPEN",     WINPM_LIDOPEN },
+	{ "POWER_SOURCE", WINPM_POWERSOURCE },
+	{ NULL }
+};
+typedef enum { EV_PERSONALITY, EV_SAVING, EV_LIDCLOSE, EV_LIDOPEN,
+	EV_SOURCE } EV_Setting;
+
+/* Settings the monitoring window registers for */
+static const struct {
+	CONST GUID *guidPtr;
+	Winpm_EventType *typePtr; /* Event scripts are bound to */
+} Settings[WINPM_SETTINGS] = {
+	{ &GuidPersonality, &SettingEvents[EV_PERSONALITY] },
+	{ &GuidPowerSaving, &SettingEvents[EV_SAVING] },
+	{ &GuidLidSwitch,   NULL }, /* These two are decoded by DecodeSwitch() */
+	{ &GuidPowerSource, NULL },
+};
+
+static int
+SameGuid (
+	CONST GUID *aPtr,
+	CONST GUID *bPtr
+	)
+{
+	return memcmp(aPtr, bPtr, sizeof(GUID)) == 0;
+}
+
+static void
+ResetSettings (
+	Winpm_InterpData *statePtr
+	)
+{
+	int i;
+
+	statePtr->settings.personality = WINPM_PROFILE_UNKNOWN;
+	statePtr->settings.saver = -1;
+	statePtr->settings.lid = -1;
+	statePtr->settings.source = -1;
+	for (i = 0; i < WINPM_SETTINGS; ++i) {
+		statePtr->settings.notify[i] = NULL;
+	}
+}
+
+void
+Winpm_InitSettings (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_RegisterEvents(SettingEvents);
+	ResetSettings(statePtr);
+}
+
+/*
+ * Registers the monitoring window for the setting notifications.
+ * The system sends the current values right away.
+ */
+void
+Winpm_RegisterSettings (
+	Winpm_InterpData *statePtr
+	)
+{
+	RegisterNotificationProc registerProc;
+	int i;
+
+	registerProc = (RegisterNotificationProc) GetProcAddress(
+			GetModuleHandle(_T("user32.dll")),
+			"RegisterPowerSettingNotification");
+	if (registerProc == NULL) return;
+
+	for (i = 0; i < WINPM_SETTINGS; ++i) {
+		statePtr->settings.notify[i] = registerProc(
+				statePtr->hwndMonitor, Settings[i].guidPtr,
+				DEVICE_NOTIFY_WINDOW_HANDLE);
+	}
+}
+
+/*
+ * Cancels the registration made by Winpm_RegisterSettings().
+ * The values are no longer tracked after that, so they become unknown.
+ */
+void
+Winpm_UnregisterSettings (
+	Winpm_InterpData *statePtr
+	)
+{
+	UnregisterNotificationProc unregisterProc;
+	int i;
+
+	unregisterProc = (UnregisterNotificationProc) GetProcAddress(
+			GetModuleHandle(_T("user32.dll")),
+			"UnregisterPowerSettingNotification");
+
+	for (i = 0; i < WINPM_SETTINGS; ++i) {
+		if (statePtr->settings.notify[i] != NULL && unregisterProc != NULL) {
+			unregisterProc(statePtr->settings.notify[i]);
+		}
+	}
+	ResetSettings(statePtr);
+}
+
+CONST char *
+Winpm_ProfileName (
+	int personality
+	)
+{
+	return Personalities[personality].name;
+}
+
+CONST char *
+Winpm_PowerSourceName (
+	int source
+	)
+{
+	return source >= 0 && source <= WINPM_SOURCE_UPS
+		? Sources[source] : "UNKNOWN";
+}
+
+/* Tells whether the notification is about the lid or the source of power */
+static int
+IsSwitchSetting (
+	CONST POWERBROADCAST_SETTING *settingPtr
+	)
+{
+	return SameGuid(&settingPtr->PowerSetting, &GuidLidSwitch)
+		|| SameGuid(&settingPtr->PowerSetting, &GuidPowerSource);
+}
+
+/*
+ * Remembers the new state of the lid or the source of power and fills
+ * in the event description. Returns the type of the event or NULL if
+ * the state hasn't changed.
+ */
+static Winpm_EventType *
+DecodeSwitch (
+	Winpm_InterpData *statePtr,
+	CONST POWERBROADCAST_SETTING *settingPtr,
+	Winpm_Event *eventPtr
+	)
+{
+	int value, prev;
+
+	if (settingPtr->DataLength < sizeof(DWORD)) return NULL;
+	value = (int) *((CONST DWORD *) settingPtr->Data);
+
+	if (SameGuid(&settingPtr->PowerSetting, &GuidLidSwitch)) {
+		value = value != 0;
+		prev = statePtr->settings.lid;
+		statePtr->settings.lid = value;
+		if (prev == -1 || prev == value) return NULL;
+
+		eventPtr->type = value ? WINPM_LIDOPEN : WINPM_LIDCLOSE;
+		return &SettingEvents[value ? EV_LIDOPEN : EV_LIDCLOSE];
+	} else {
+		prev = statePtr->settings.source;
+		statePtr->settings.source = value;
+		if (prev == -1 || prev == value) return NULL;
+
+		eventPtr->type = WINPM_POWERSOURCE;
+		eventPtr->source = value;
+		return &SettingEvents[EV_SOURCE];
+	}
+}
+
+/*
+ * Decoder of PBT_POWERSETTINGCHANGE: remembers the new value of the
+ * setting lParam points to and fills in the event description. The
+ * event of the setting, if it's one we're watching, is the detail.
+ */
+int
+Winpm_DecodeSetting (
+	Winpm_InterpData *statePtr,
+	LPARAM lParam,
+	Winpm_Event *eventPtr,
+	Winpm_EventType **detailPtr
+	)
+{
+	CONST POWERBROADCAST_SETTING *settingPtr;
+	int i;
+
+	settingPtr = (CONST POWERBROADCAST_SETTING *) lParam;
+	eventPtr->type = 0;
+	*detailPtr = NULL;
+	if (settingPtr == NULL) return 1;
+
+	if (IsSwitchSetting(settingPtr)) {
+		*detailPtr = DecodeSwitch(statePtr, settingPtr, eventPtr);
+		return 0;
+	}
+
+	for (i = 0; i < WINPM_SETTINGS; ++i) {
+		if (SameGuid(&settingPtr->PowerSetting, Settings[i].guidPtr)) {
+			break;
+		}
+	}
+	if (i == WINPM_SETTINGS) return 1;
+
+	if (SameGuid(Settings[i].guidPtr, &GuidPersonality)) {
+		int p;
+
+		if (settingPtr->DataLength < sizeof(GUID)) return 1;
+		statePtr->settings.personality = WINPM_PROFILE_UNKNOWN;
+		for (p = 1; p < sizeof(Personalities)/sizeof(Personalities[0]); ++p) {
+			if (SameGuid((CONST GUID *) settingPtr->Data,
+					&Personalities[p].guid)) {
+				statePtr->settings.personality = p;
+				break;
+			}
+		}
+	} else {
+		if (settingPtr->DataLength < sizeof(DWORD)) return 1;
+		statePtr->settings.saver =
+			*((CONST DWORD *) settingPtr->Data) != 0;
+	}
+
+	eventPtr->type = WINPM_PROFILECHANGE;
+	eventPtr->profile.personality = statePtr->settings.personality;
+	eventPtr->profile.saver = statePtr->settings.saver;
+	*detailPtr = Settings[i].typePtr;
+
+	return 1;
+}
+
+/*
+ * Loads powrprof.dll, if not yet loaded. The library is never unloaded
+ * since other interpreters may be using it. Returns 0 on failure.
+ */
+static int
+LoadPowrprof (void)
+{
+	static int loaded = 0;
+	HMODULE hmod;
+
+	if (loaded) return loaded > 0;
+
+	Tcl_MutexLock(&powrprofMutex);
+	if (loaded == 0) {
+		loaded = -1;
+		hmod = LoadLibrary(_T("powrprof.dll"));
+		if (hmod != NULL) {
+			getActiveSchemeProc = (GetActiveSchemeProc)
+				GetProcAddress(hmod, "PowerGetActiveScheme");
+			if (getActiveSchemeProc != NULL) {
+				loaded = 1;
+			}
+		}
+	}
+	Tcl_MutexUnlock(&powrprofMutex);
+
+	return loaded > 0;
+}
+
+/*
+ * Asks the system for the profile when there are no notifications to
+ * take it from. Only the default power schemes have a known
+ * personality; both values stay unknown before Vista.
+ */
+static void
+QueryProfile (
+	int *personalityPtr,
+	int *saverPtr
+	)
+{
+	GUID *schemePtr;
+	PowerStatus status;
+	int p;
+
+	*personalityPtr = WINPM_PROFILE_UNKNOWN;
+	*saverPtr = -1;
+	if (!LoadPowrprof()) return;
+
+	if (getActiveSchemeProc(NULL, &schemePtr) == ERROR_SUCCESS) {
+		for (p = 1; p < sizeof(Personalities)/sizeof(Personalities[0]); ++p) {
+			if (SameGuid(schemePtr, &Personalities[p].guid)) {
+				*personalityPtr = p;
+				break;
+			}
+		}
+		LocalFree(schemePtr);
+	}
+
+	if (GetSystemPowerStatus((SYSTEM_POWER_STATUS *) &status)) {
+		*saverPtr = status.statusFlag & 1;
+	}
+}
+
+/* Returns the profile in the form [winpm info profile] reports it */
+Tcl_Obj *
+Winpm_NewProfileObj (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_Obj *elems[4];
+	int personality, saver;
+
+	if (statePtr->hwndMonitor != NULL) {
+		personality = statePtr->settings.personality;
+		saver = statePtr->settings.saver;
+	} else {
+		QueryProfile(&personality, &saver);
+	}
+
+	elems[0] = Tcl_NewStringObj("personality", -1);
+	elems[1] = Tcl_NewStringObj(Winpm_ProfileName(personality), -1);
+	elems[2] = Tcl_NewStringObj("saver", -1);
+	elems[3] = Tcl_NewIntObj(saver);
+
+	return Tcl_NewListObj(4, elems);
+}
+
+/*
+ * winpm _setting personality NAME
+ * winpm _setting saver BOOLEAN
+ * winpm _setting lid BOOLEAN
+ * winpm _setting source AC|DC|UPS
+ *
+ * Sends the monitoring window the notification the system would send
+ * if the setting changed and returns the result of SendMessage().
+ */
+int
+Winpm_CmdSetting (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *settings[] = { "lid", "personality", "saver",
+		"source", NULL };
+	typedef enum { SET_LID, SET_PERSONALITY, SET_SAVER,
+		SET_SOURCE } SET_Setting;
+	static const char *names[] = { "power-saver", "balanced",
+		"performance", NULL };
+	union {
+		POWERBROADCAST_SETTING setting;
+		char buf[sizeof(POWERBROADCAST_SETTING) + sizeof(GUID)];
+	} u;
+	int set, val;
+	LRESULT res;
+
+	if (objc != 4) {
+		Tcl_WrongNumArgs(interp, 2, objv, "setting value");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], settings, "setting",
+			0, &set) != TCL_OK) { return TCL_ERROR; }
+
+	memset(&u, 0, sizeof(u));
+	switch (set) {
+		case SET_LID:
+		case SET_SOURCE: {
+			DWORD dw;
+
+			if (set == SET_LID) {
+				if (Tcl_GetBooleanFromObj(interp, objv[3], &val) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				u.setting.PowerSetting = GuidLidSwitch;
+			} else {
+				if (Tcl_GetIndexFromObj(interp, objv[3], Sources, "source",
+						0, &val) != TCL_OK) { return TCL_ERROR; }
+				u.setting.PowerSetting = GuidPowerSource;
+			}
+			dw = val;
+			u.setting.DataLength = sizeof(DWORD);
+			memcpy(u.setting.Data, &dw, sizeof(DWORD));
+		}
+		break;
+
+		case SET_PERSONALITY:
+			if (Tcl_GetIndexFromObj(interp, objv[3], names, "personality",
+					0, &val) != TCL_OK) { return TCL_ERROR; }
+			u.setting.PowerSetting = GuidPersonality;
+			u.setting.DataLength = sizeof(GUID);
+			memcpy(u.setting.Data, &Personalities[val + 1].guid,
+					sizeof(GUID));
+		break;
+
+		case SET_SAVER: {
+			DWORD dw;
+
+			if (Tcl_GetBooleanFromObj(interp, objv[3], &val) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			dw = val;
+			u.setting.PowerSetting = GuidPowerSaving;
+			u.setting.DataLength = sizeof(DWORD);
+			memcpy(u.setting.Data, &dw, sizeof(DWORD));
+		}
+		break;
+	}
+
+	if (Winpm_HoldMonitor(statePtr) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	res = SendMessage(statePtr->hwndMonitor, WM_POWERBROADCAST,
+			PBT_POWERSETTINGCHANGE, (LPARAM) &u.setting);
+	Winpm_ReleaseMonitor(statePtr);
+	Tcl_SetObjResult(interp, Tcl_NewLongObj((long) res));
+
+	return TCL_OK;
+}
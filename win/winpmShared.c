@@ -0,0 +1,324 @@
+/*
+ * winpmShared.c --
+ *   Publishing the power status to other processes.
+ *
+ *   When many processes on the same machine want the power status,
+ *   one of them (the publisher) keeps its snapshot in a small file
+ *   mapped into memory and the others attach to that file and read
+ *   the status from there instead of asking the system each time.
+ *
+ *   The file is protected by a sequence lock: the publisher makes the
+ *   sequence number odd before changing the status and even again
+ *   after that; a reader copies the status and retries if the number
+ *   was odd or changed meanwhile. So readers never block the publisher
+ *   and never make system calls, and there may be any number of them.
+ *
+ *   The publisher also stamps the file with the tick count each second.
+ *   A publisher which was killed can't take its status back, so
+ *   readers go back to the system once the stamp gets old.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+#define SHARED_MAGIC   0x4D505457 /* "WTPM" */
+#define SHARED_VERSION 2
+
+/* Number of attempts a reader makes before asking the system itself */
+#define SHARED_RETRIES 1000
+
+/* How often the publisher stamps the file and how old the stamp may
+ * get before readers stop trusting the status, milliseconds */
+#define SHARED_HEARTBEAT 1000
+#define SHARED_STALE     5000
+
+/* Layout of the file */
+struct Winpm_SharedPower {
+	DWORD magic;
+	DWORD version;
+	volatile LONG sequence; /* Odd while the status is being changed */
+	DWORD publisher; /* Id of the publishing process */
+	LONG valid; /* Set if the status could be obtained */
+	volatile LONG heartbeat; /* GetTickCount() of the publisher's stamp */
+	SYSTEM_POWER_STATUS status;
+};
+
+/* Stamps the file as published by a live process and rearms the timer */
+static void
+Heartbeat (
+	ClientData clientData
+	)
+{
+	Winpm_InterpData *statePtr = (Winpm_InterpData *) clientData;
+
+	InterlockedExchange(&statePtr->shared.viewPtr->heartbeat,
+			(LONG) GetTickCount());
+	statePtr->shared.heartbeat = Tcl_CreateTimerHandler(SHARED_HEARTBEAT,
+			Heartbeat, clientData);
+}
+
+void
+Winpm_InitShared (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->shared.file = INVALID_HANDLE_VALUE;
+	statePtr->shared.mapping = NULL;
+	statePtr->shared.viewPtr = NULL;
+	statePtr->shared.publisher = 0;
+	statePtr->shared.pathObj = NULL;
+	statePtr->shared.heartbeat = NULL;
+}
+
+/* Unmaps the file, if any, and stops publishing */
+void
+Winpm_FinalizeShared (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_SharedPower *sharedPtr = statePtr->shared.viewPtr;
+
+	if (statePtr->shared.heartbeat != NULL) {
+		Tcl_DeleteTimerHandler(statePtr->shared.heartbeat);
+	}
+	if (statePtr->shared.publisher) {
+		/* Send the readers back to the system */
+		InterlockedIncrement(&sharedPtr->sequence);
+		sharedPtr->valid = 0;
+		InterlockedIncrement(&sharedPtr->sequence);
+	}
+	if (statePtr->shared.viewPtr != NULL) {
+		UnmapViewOfFile((LPCVOID) statePtr->shared.viewPtr);
+	}
+	if (statePtr->shared.mapping != NULL) {
+		CloseHandle(statePtr->shared.mapping);
+	}
+	if (statePtr->shared.file != INVALID_HANDLE_VALUE) {
+		CloseHandle(statePtr->shared.file);
+	}
+	if (statePtr->shared.pathObj != NULL) {
+		Tcl_DecrRefCount(statePtr->shared.pathObj);
+	}
+	if (statePtr->shared.publisher) {
+		Winpm_ReleaseMonitor(statePtr);
+	}
+	Winpm_InitShared(statePtr);
+}
+
+/*
+ * Writes the current power status to the file if this interpreter
+ * is the publisher. Called each time the status may have changed.
+ */
+void
+Winpm_PublishPower (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_SharedPower *sharedPtr = statePtr->shared.viewPtr;
+	SYSTEM_POWER_STATUS status;
+	BOOL valid;
+
+	if (!statePtr->shared.publisher) return;
+
+	valid = Winpm_GetPowerStatus(statePtr, &status);
+
+	/* The interlocked operations are full memory barriers */
+	InterlockedIncrement(&sharedPtr->sequence);
+	sharedPtr->valid = valid;
+	if (valid) {
+		sharedPtr->status = status;
+	}
+	InterlockedIncrement(&sharedPtr->sequence);
+}
+
+/*
+ * Copies the status published in the attached file. Returns 0 if no
+ * file is attached, the status hasn't been obtained by the publisher,
+ * the publisher hasn't stamped the file for a while or keeps changing
+ * the status (perhaps it died while doing that), so that the caller
+ * asks the system instead.
+ */
+int
+Winpm_ReadSharedPower (
+	Winpm_InterpData *statePtr,
+	SYSTEM_POWER_STATUS *statusPtr
+	)
+{
+	Winpm_SharedPower *sharedPtr = statePtr->shared.viewPtr;
+	LONG before, after;
+	int i, valid;
+
+	if (sharedPtr == NULL || statePtr->shared.publisher) return 0;
+
+	/* Unsigned difference survives the wrap of the tick count */
+	if (GetTickCount() - (DWORD) sharedPtr->heartbeat > SHARED_STALE) {
+		return 0;
+	}
+
+	for (i = 0; i < SHARED_RETRIES; ++i) {
+		before = InterlockedCompareExchange(&sharedPtr->sequence, 0, 0);
+		if (before & 1) continue;
+
+		valid = sharedPtr->valid;
+		*statusPtr = sharedPtr->status;
+
+		after = InterlockedCompareExchange(&sharedPtr->sequence, 0, 0);
+		if (after == before) return valid;
+	}
+
+	return 0;
+}
+
+/*
+ * Opens and maps the file, creating it if the caller is going to
+ * publish. Returns TCL_ERROR, leaving the message in the interpreter,
+ * on failure; nothing is changed in that case.
+ */
+static int
+MapFile (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	Tcl_Obj *pathObj,
+	int publish
+	)
+{
+	CONST TCHAR *nativePath;
+	HANDLE file, mapping;
+	Winpm_SharedPower *sharedPtr;
+	DWORD error;
+
+	nativePath = (CONST TCHAR *) Tcl_FSGetNativePath(pathObj);
+	if (nativePath == NULL) {
+		Tcl_AppendResult(interp, "bad path \"", Tcl_GetString(pathObj),
+				"\"", NULL);
+		return TCL_ERROR;
+	}
+
+	file = CreateFile(nativePath,
+			publish ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+			FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+			publish ? OPEN_ALWAYS : OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		error = GetLastError();
+		goto systemError;
+	}
+
+	mapping = CreateFileMapping(file, NULL,
+			publish ? PAGE_READWRITE : PAGE_READONLY,
+			0, sizeof(Winpm_SharedPower), NULL);
+	if (mapping == NULL) {
+		error = GetLastError();
+		CloseHandle(file);
+		goto systemError;
+	}
+
+	sharedPtr = (Winpm_SharedPower *) MapViewOfFile(mapping,
+			publish ? FILE_MAP_WRITE : FILE_MAP_READ,
+			0, 0, sizeof(Winpm_SharedPower));
+	if (sharedPtr == NULL) {
+		error = GetLastError();
+		CloseHandle(mapping);
+		CloseHandle(file);
+		goto systemError;
+	}
+
+	if (publish) {
+		/* Readers see an odd sequence until the first status is in */
+		sharedPtr->magic = SHARED_MAGIC;
+		sharedPtr->version = SHARED_VERSION;
+		sharedPtr->sequence = 1;
+		sharedPtr->publisher = GetCurrentProcessId();
+		sharedPtr->valid = 0;
+		sharedPtr->heartbeat = (LONG) GetTickCount();
+		InterlockedIncrement(&sharedPtr->sequence);
+	} else if (sharedPtr->magic != SHARED_MAGIC
+			|| sharedPtr->version != SHARED_VERSION) {
+		UnmapViewOfFile((LPCVOID) sharedPtr);
+		CloseHandle(mapping);
+		CloseHandle(file);
+		Tcl_AppendResult(interp, "\"", Tcl_GetString(pathObj),
+				"\" is not a published power status", NULL);
+		return TCL_ERROR;
+	}
+
+	Winpm_FinalizeShared(statePtr);
+
+	statePtr->shared.file = file;
+	statePtr->shared.mapping = mapping;
+	statePtr->shared.viewPtr = sharedPtr;
+	statePtr->shared.pathObj = pathObj;
+	Tcl_IncrRefCount(pathObj);
+
+	return TCL_OK;
+
+systemError:
+	Tcl_AppendResult(interp, "couldn't map \"", Tcl_GetString(pathObj),
+			"\": ", NULL);
+	Winpm_AppendSystemError(interp, error);
+	return TCL_ERROR;
+}
+
+/*
+ * winpm publish ?path?
+ * winpm attach ?path?
+ *
+ * Without the path returns the path of the file published or attached
+ * to with the same subcommand, if any; an empty path stops that.
+ */
+int
+Winpm_CmdShared (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int publish,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	int len;
+
+	if (objc == 2) {
+		if (statePtr->shared.pathObj != NULL
+				&& statePtr->shared.publisher == publish) {
+			Tcl_SetObjResult(interp, statePtr->shared.pathObj);
+		}
+		return TCL_OK;
+	}
+
+	if (objc != 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "?path?");
+		return TCL_ERROR;
+	}
+
+	Tcl_GetStringFromObj(objv[2], &len);
+	if (len == 0) {
+		if (statePtr->shared.publisher == publish) {
+			Winpm_FinalizeShared(statePtr);
+		}
+		return TCL_OK;
+	}
+
+	/* Publishing needs the power status notifications */
+	if (publish && Winpm_HoldMonitor(statePtr) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	if (MapFile(interp, statePtr, objv[2], publish) != TCL_OK) {
+		if (publish) {
+			Winpm_ReleaseMonitor(statePtr);
+		}
+		return TCL_ERROR;
+	}
+
+	statePtr->shared.publisher = publish;
+	Winpm_PublishPower(statePtr);
+	if (publish) {
+		Heartbeat((ClientData) statePtr);
+	}
+	return TCL_OK;
+}
@@ -0,0 +1,675 @@
+/*
+ * winpmShutdown.c --
+ *   Deadline-bounded shutdown phase run when the session ends.
+ *
+ *   When WM_ENDSESSION arrives the process has only a few seconds left
+ *   before Windows terminates it. The handlers registered from C are
+ *   handed to a small pool of worker threads while the handlers
+ *   registered from Tcl are evaluated in the owning interpreter (they
+ *   can't leave its thread) under the time limit derived from the same
+ *   deadline. Whatever is still running when the deadline hits is
+ *   reported and abandoned.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+#define DEFAULT_DEADLINE 4000 /* ms */
+#define DEFAULT_WORKERS  4
+
+struct Winpm_ShutdownHandler {
+	char *name;
+	Tcl_Obj *scriptObj; /* Set for handlers registered from Tcl */
+	Winpm_ShutdownProc *proc; /* Set for handlers registered from C */
+	ClientData clientData;
+	Winpm_ShutdownHandler *nextPtr;
+};
+
+typedef enum {
+	JOB_PENDING, JOB_RUNNING, JOB_DONE
+} JobState;
+
+typedef struct {
+	char *name;
+	Winpm_ShutdownProc *proc;
+	ClientData clientData;
+	JobState state;
+	int code;
+	Tcl_Time started;
+	Tcl_Time finished;
+} ShutdownJob;
+
+/*
+ * State of one run of the C handlers, shared between the interp's
+ * thread and the workers. It is reference counted since the workers
+ * running abandoned handlers may outlive the phase (and the interp).
+ */
+typedef struct {
+	Tcl_Mutex mutex;
+	Tcl_Condition done;
+	int refCount;
+	int numJobs;
+	int nextJob;
+	int numDone;
+	ShutdownJob *jobs;
+} ShutdownPool;
+
+static void
+ReleasePool (
+	ShutdownPool *poolPtr
+	)
+{
+	int i, last;
+
+	Tcl_MutexLock(&poolPtr->mutex);
+	last = --poolPtr->refCount == 0;
+	Tcl_MutexUnlock(&poolPtr->mutex);
+
+	if (!last) return;
+
+	for (i = 0; i < poolPtr->numJobs; ++i) {
+		ckfree(poolPtr->jobs[i].name);
+	}
+	ckfree((char *) poolPtr->jobs);
+	Tcl_ConditionFinalize(&poolPtr->done);
+	Tcl_MutexFinalize(&poolPtr->mutex);
+	ckfree((char *) poolPtr);
+}
+
+/*
+ * Runs the pending jobs of the pool one by one until none is left.
+ * Used both as the body of the worker threads and as a fallback on the
+ * interp's thread when the threads can't be created.
+ */
+static void
+DrainPool (
+	ShutdownPool *poolPtr
+	)
+{
+	ShutdownJob *jobPtr;
+	int code;
+
+	Tcl_MutexLock(&poolPtr->mutex);
+	while (poolPtr->nextJob < poolPtr->numJobs) {
+		jobPtr = &poolPtr->jobs[poolPtr->nextJob++];
+		jobPtr->state = JOB_RUNNING;
+		Tcl_GetTime(&jobPtr->started);
+		Tcl_MutexUnlock(&poolPtr->mutex);
+
+		code = jobPtr->proc(jobPtr->clientData);
+
+		Tcl_MutexLock(&poolPtr->mutex);
+		jobPtr->code = code;
+		jobPtr->state = JOB_DONE;
+		Tcl_GetTime(&jobPtr->finished);
+		++poolPtr->numDone;
+		Tcl_ConditionNotify(&poolPtr->done);
+	}
+	Tcl_MutexUnlock(&poolPtr->mutex);
+}
+
+static Tcl_ThreadCreateType
+ShutdownWorker (
+	ClientData clientData
+	)
+{
+	ShutdownPool *poolPtr = (ShutdownPool *) clientData;
+
+	DrainPool(poolPtr);
+	ReleasePool(poolPtr);
+
+	TCL_THREAD_CREATE_RETURN;
+}
+
+static long
+ElapsedMs (
+	CONST Tcl_Time *fromPtr,
+	CONST Tcl_Time *toPtr
+	)
+{
+	return (toPtr->sec - fromPtr->sec) * 1000
+		+ (toPtr->usec - fromPtr->usec) / 1000;
+}
+
+static void
+AppendResult (
+	Tcl_Obj *listObj,
+	CONST char *name,
+	CONST char *kind,
+	CONST char *status,
+	long elapsed,
+	Tcl_Obj *msgObj
+	)
+{
+	Tcl_Obj *elems[5];
+
+	elems[0] = Tcl_NewStringObj(name, -1);
+	elems[1] = Tcl_NewStringObj(kind, -1);
+	elems[2] = Tcl_NewStringObj(status, -1);
+	elems[3] = Tcl_NewLongObj(elapsed);
+	elems[4] = msgObj != NULL ? msgObj : Tcl_NewObj();
+
+	Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewListObj(5, elems));
+}
+
+static void
+SetResults (
+	Winpm_InterpData *statePtr,
+	Tcl_Obj *resultsObj
+	)
+{
+	if (statePtr->shutdown.results != NULL) {
+		Tcl_DecrRefCount(statePtr->shutdown.results);
+	}
+	statePtr->shutdown.results = resultsObj;
+	if (resultsObj != NULL) {
+		Tcl_IncrRefCount(resultsObj);
+	}
+}
+
+/*
+ * Runs all registered shutdown handlers under the common deadline and
+ * records their outcome which then can be inspected using
+ * [winpm shutdown results]. Returns the number of handlers which
+ * haven't completed successfully.
+ */
+int
+Winpm_RunShutdownPhase (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_Interp *interp = statePtr->interp;
+	Winpm_ShutdownHandler *hPtr;
+	ShutdownPool *poolPtr;
+	Tcl_Time start, deadline, now;
+	Tcl_Obj *resultsObj, *scriptsObj, **scriptv;
+	int numC, numWorkers, numScripts, i, failed;
+
+	Tcl_GetTime(&start);
+	deadline.sec  = start.sec + statePtr->shutdown.deadline / 1000;
+	deadline.usec = start.usec + (statePtr->shutdown.deadline % 1000) * 1000;
+	if (deadline.usec >= 1000000) {
+		deadline.usec -= 1000000;
+		++deadline.sec;
+	}
+
+	resultsObj = Tcl_NewListObj(0, NULL);
+	Tcl_IncrRefCount(resultsObj);
+	failed = 0;
+
+	/* Hand the C handlers off to the workers first
+	 * so that they run while we're busy with the scripts */
+
+	numC = 0;
+	for (hPtr = statePtr->shutdown.handlers; hPtr; hPtr = hPtr->nextPtr) {
+		if (hPtr->proc != NULL) ++numC;
+	}
+
+	poolPtr = NULL;
+	if (numC > 0) {
+		poolPtr = (ShutdownPool *) ckalloc(sizeof(ShutdownPool));
+		memset(poolPtr, 0, sizeof(*poolPtr));
+		poolPtr->refCount = 1;
+		poolPtr->numJobs = numC;
+		poolPtr->jobs = (ShutdownJob *) ckalloc(numC * sizeof(ShutdownJob));
+		memset(poolPtr->jobs, 0, numC * sizeof(ShutdownJob));
+
+		i = 0;
+		for (hPtr = statePtr->shutdown.handlers; hPtr; hPtr = hPtr->nextPtr) {
+			if (hPtr->proc == NULL) continue;
+			poolPtr->jobs[i].name = ckalloc(strlen(hPtr->name) + 1);
+			strcpy(poolPtr->jobs[i].name, hPtr->name);
+			poolPtr->jobs[i].proc = hPtr->proc;
+			poolPtr->jobs[i].clientData = hPtr->clientData;
+			poolPtr->jobs[i].state = JOB_PENDING;
+			++i;
+		}
+
+		numWorkers = statePtr->shutdown.workers;
+		if (numWorkers > numC) numWorkers = numC;
+		for (i = 0; i < numWorkers; ++i) {
+			Tcl_ThreadId id;
+
+			Tcl_MutexLock(&poolPtr->mutex);
+			++poolPtr->refCount;
+			Tcl_MutexUnlock(&poolPtr->mutex);
+			if (Tcl_CreateThread(&id, ShutdownWorker, (ClientData) poolPtr,
+					TCL_THREAD_STACK_DEFAULT, TCL_THREAD_NOFLAGS) != TCL_OK) {
+				Tcl_MutexLock(&poolPtr->mutex);
+				--poolPtr->refCount;
+				Tcl_MutexUnlock(&poolPtr->mutex);
+				break;
+			}
+		}
+		if (i == 0) {
+			/* No threads available (non-threaded build?) */
+			DrainPool(poolPtr);
+		}
+	}
+
+	/* Now run the scripts, each limited by what is left of the deadline.
+	 * They are copied out first since a script is free to (un)register
+	 * handlers while we're walking the list */
+
+	scriptsObj = Tcl_NewListObj(0, NULL);
+	Tcl_IncrRefCount(scriptsObj);
+	for (hPtr = statePtr->shutdown.handlers; hPtr; hPtr = hPtr->nextPtr) {
+		if (hPtr->scriptObj == NULL) continue;
+		Tcl_ListObjAppendElement(NULL, scriptsObj,
+				Tcl_NewStringObj(hPtr->name, -1));
+		Tcl_ListObjAppendElement(NULL, scriptsObj, hPtr->scriptObj);
+	}
+	Tcl_ListObjGetElements(NULL, scriptsObj, &numScripts, &scriptv);
+
+	for (i = 0; i < numScripts; i += 2) {
+		CONST char *name = Tcl_GetString(scriptv[i]);
+		Tcl_Time before, after;
+		int code, expired;
+
+		Tcl_GetTime(&before);
+		if (ElapsedMs(&before, &deadline) <= 0) {
+			AppendResult(resultsObj, name, "tcl", "skipped", 0, NULL);
+			++failed;
+			continue;
+		}
+
+		code = Winpm_EvalLimited(interp, scriptv[i+1], &deadline, &expired);
+		Tcl_GetTime(&after);
+
+		if (expired) {
+			AppendResult(resultsObj, name, "tcl", "timeout",
+					ElapsedMs(&before, &after), NULL);
+			++failed;
+		} else if (code == TCL_ERROR) {
+			AppendResult(resultsObj, name, "tcl", "error",
+					ElapsedMs(&before, &after), Tcl_GetObjResult(interp));
+			++failed;
+		} else {
+			AppendResult(resultsObj, name, "tcl", "ok",
+					ElapsedMs(&before, &after), NULL);
+		}
+		Tcl_ResetResult(interp);
+	}
+	Tcl_DecrRefCount(scriptsObj);
+
+	/* Collect the workers' results, waiting no longer than the deadline */
+
+	if (poolPtr != NULL) {
+		Tcl_MutexLock(&poolPtr->mutex);
+		while (poolPtr->numDone < poolPtr->numJobs) {
+			Tcl_Time wait;
+			long left;
+
+			Tcl_GetTime(&now);
+			left = ElapsedMs(&now, &deadline);
+			if (left <= 0) break;
+			wait.sec  = left / 1000;
+			wait.usec = (left % 1000) * 1000;
+			Tcl_ConditionWait(&poolPtr->done, &poolPtr->mutex, &wait);
+		}
+
+		Tcl_GetTime(&now);
+		for (i = 0; i < poolPtr->numJobs; ++i) {
+			ShutdownJob *jobPtr = &poolPtr->jobs[i];
+
+			switch (jobPtr->state) {
+				case JOB_PENDING:
+					AppendResult(resultsObj, jobPtr->name, "c",
+							"skipped", 0, NULL);
+					++failed;
+				break;
+
+				case JOB_RUNNING:
+					AppendResult(resultsObj, jobPtr->name, "c", "abandoned",
+							ElapsedMs(&jobPtr->started, &now), NULL);
+					++failed;
+				break;
+
+				case JOB_DONE:
+					AppendResult(resultsObj, jobPtr->name, "c",
+							jobPtr->code == TCL_OK ? "ok" : "error",
+							ElapsedMs(&jobPtr->started, &jobPtr->finished),
+							NULL);
+					if (jobPtr->code != TCL_OK) ++failed;
+				break;
+			}
+		}
+
+		/* Jobs nobody has picked up yet must not be started anymore */
+		poolPtr->nextJob = poolPtr->numJobs;
+		Tcl_MutexUnlock(&poolPtr->mutex);
+
+		ReleasePool(poolPtr);
+	}
+
+	SetResults(statePtr, resultsObj);
+	Tcl_DecrRefCount(resultsObj);
+
+	return failed;
+}
+
+static Winpm_ShutdownHandler *
+FindHandler (
+	Winpm_InterpData *statePtr,
+	CONST char *name,
+	Winpm_ShutdownHandler ***linkPtrPtr
+	)
+{
+	Winpm_ShutdownHandler **linkPtr;
+
+	linkPtr = &statePtr->shutdown.handlers;
+	while (*linkPtr != NULL) {
+		if (strcmp((*linkPtr)->name, name) == 0) break;
+		linkPtr = &(*linkPtr)->nextPtr;
+	}
+	if (linkPtrPtr != NULL) {
+		*linkPtrPtr = linkPtr;
+	}
+	return *linkPtr;
+}
+
+static void
+FreeHandler (
+	Winpm_ShutdownHandler *hPtr
+	)
+{
+	if (hPtr->scriptObj != NULL) {
+		Tcl_DecrRefCount(hPtr->scriptObj);
+	}
+	ckfree(hPtr->name);
+	ckfree((char *) hPtr);
+}
+
+static void
+DeleteHandler (
+	Winpm_InterpData *statePtr,
+	CONST char *name
+	)
+{
+	Winpm_ShutdownHandler **linkPtr, *hPtr;
+
+	hPtr = FindHandler(statePtr, name, &linkPtr);
+	if (hPtr != NULL) {
+		*linkPtr = hPtr->nextPtr;
+		FreeHandler(hPtr);
+		Winpm_ReleaseMonitor(statePtr);
+	}
+}
+
+/*
+ * Installs a new handler or replaces the existing one with the same name
+ * keeping its position in the run order. Returns TCL_ERROR, leaving
+ * the message in the interpreter, if the monitoring window (needed to
+ * learn about the session ending) couldn't be created.
+ */
+static int
+SetHandler (
+	Winpm_InterpData *statePtr,
+	CONST char *name,
+	Tcl_Obj *scriptObj,
+	Winpm_ShutdownProc *proc,
+	ClientData clientData
+	)
+{
+	Winpm_ShutdownHandler **linkPtr, *hPtr;
+
+	hPtr = FindHandler(statePtr, name, &linkPtr);
+	if (hPtr == NULL) {
+		if (Winpm_HoldMonitor(statePtr) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		hPtr = (Winpm_ShutdownHandler *) ckalloc(sizeof(*hPtr));
+		hPtr->name = ckalloc(strlen(name) + 1);
+		strcpy(hPtr->name, name);
+		hPtr->nextPtr = NULL;
+		*linkPtr = hPtr;
+	} else if (hPtr->scriptObj != NULL) {
+		Tcl_DecrRefCount(hPtr->scriptObj);
+	}
+
+	hPtr->scriptObj = scriptObj;
+	if (scriptObj != NULL) {
+		Tcl_IncrRefCount(scriptObj);
+	}
+	hPtr->proc = proc;
+	hPtr->clientData = clientData;
+	return TCL_OK;
+}
+
+void
+Winpm_InitShutdown (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->shutdown.handlers = NULL;
+	statePtr->shutdown.deadline = DEFAULT_DEADLINE;
+	statePtr->shutdown.workers  = DEFAULT_WORKERS;
+	statePtr->shutdown.results  = NULL;
+}
+
+void
+Winpm_FinalizeShutdown (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_ShutdownHandler *hPtr, *nextPtr;
+
+	for (hPtr = statePtr->shutdown.handlers; hPtr; hPtr = nextPtr) {
+		nextPtr = hPtr->nextPtr;
+		FreeHandler(hPtr);
+	}
+	statePtr->shutdown.handlers = NULL;
+	SetResults(statePtr, NULL);
+}
+
+int
+Winpm_CreateShutdownHandler (
+	Tcl_Interp *interp,
+	CONST char *name,
+	Winpm_ShutdownProc *proc,
+	ClientData clientData
+	)
+{
+	Winpm_InterpData *statePtr;
+
+	statePtr = Winpm_GetInterpData(interp);
+	if (statePtr == NULL) return TCL_ERROR;
+
+	return SetHandler(statePtr, name, NULL, proc, clientData);
+}
+
+int
+Winpm_DeleteShutdownHandler (
+	Tcl_Interp *interp,
+	CONST char *name
+	)
+{
+	Winpm_InterpData *statePtr;
+
+	statePtr = Winpm_GetInterpData(interp);
+	if (statePtr == NULL) return TCL_ERROR;
+
+	DeleteHandler(statePtr, name);
+	return TCL_OK;
+}
+
+/*
+ * winpm shutdown handler
+ * winpm shutdown handler NAME
+ * winpm shutdown handler NAME SCRIPT
+ */
+static int
+CmdHandler (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Winpm_ShutdownHandler *hPtr;
+
+	switch (objc) {
+		case 3: { /* List handlers in the order they are run */
+			Tcl_Obj *listObj;
+
+			listObj = Tcl_NewListObj(0, NULL);
+			for (hPtr = statePtr->shutdown.handlers; hPtr;
+					hPtr = hPtr->nextPtr) {
+				Tcl_ListObjAppendElement(interp, listObj,
+						Tcl_NewStringObj(hPtr->name, -1));
+			}
+			Tcl_SetObjResult(interp, listObj);
+			return TCL_OK;
+		}
+		break;
+
+		case 4: /* Show the script of a handler */
+			hPtr = FindHandler(statePtr, Tcl_GetString(objv[3]), NULL);
+			if (hPtr != NULL && hPtr->scriptObj != NULL) {
+				Tcl_SetObjResult(interp, hPtr->scriptObj);
+			}
+			return TCL_OK;
+		break;
+
+		case 5: { /* Create, replace or delete a handler */
+			int len;
+
+			Tcl_GetStringFromObj(objv[4], &len);
+			if (len == 0) {
+				DeleteHandler(statePtr, Tcl_GetString(objv[3]));
+				return TCL_OK;
+			}
+			return SetHandler(statePtr, Tcl_GetString(objv[3]), objv[4],
+					NULL, NULL);
+		}
+		break;
+
+		default:
+			Tcl_WrongNumArgs(interp, 3, objv, "?name? ?script?");
+			return TCL_ERROR;
+		break;
+	}
+}
+
+/* winpm shutdown configure ?-option? ?value -option value ...? */
+static int
+CmdConfigure (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *options[] = { "-deadline", "-workers", NULL };
+	typedef enum { OPT_DEADLINE, OPT_WORKERS } CFG_Option;
+	int *values[2];
+	int i, opt, value;
+
+	values[OPT_DEADLINE] = &statePtr->shutdown.deadline;
+	values[OPT_WORKERS]  = &statePtr->shutdown.workers;
+
+	if (objc == 3) {
+		Tcl_Obj *listObj;
+
+		listObj = Tcl_NewListObj(0, NULL);
+		for (i = 0; options[i] != NULL; ++i) {
+			Tcl_ListObjAppendElement(interp, listObj,
+					Tcl_NewStringObj(options[i], -1));
+			Tcl_ListObjAppendElement(interp, listObj,
+					Tcl_NewIntObj(*values[i]));
+		}
+		Tcl_SetObjResult(interp, listObj);
+		return TCL_OK;
+	}
+
+	if (objc == 4) {
+		if (Tcl_GetIndexFromObj(interp, objv[3], options, "option",
+				0, &opt) != TCL_OK) { return TCL_ERROR; }
+		Tcl_SetObjResult(interp, Tcl_NewIntObj(*values[opt]));
+		return TCL_OK;
+	}
+
+	if (objc % 2 == 0) {
+		Tcl_WrongNumArgs(interp, 3, objv, "?-option value ...?");
+		return TCL_ERROR;
+	}
+
+	for (i = 3; i < objc; i += 2) {
+		if (Tcl_GetIndexFromObj(interp, objv[i], options, "option",
+				0, &opt) != TCL_OK
+				|| Tcl_GetIntFromObj(interp, objv[i+1], &value) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		if (value < (opt == OPT_WORKERS ? 1 : 0)) {
+			Tcl_AppendResult(interp, "bad value for ", options[opt],
+					": \"", Tcl_GetString(objv[i+1]), "\"", NULL);
+			return TCL_ERROR;
+		}
+		*values[opt] = value;
+	}
+
+	return TCL_OK;
+}
+
+/* winpm shutdown subcommand ?arg ...? */
+int
+Winpm_CmdShutdown (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *subcmds[] = { "configure", "handler",
+		"results", "run", NULL };
+	typedef enum { SDN_CONFIGURE, SDN_HANDLER,
+		SDN_RESULTS, SDN_RUN } SDN_Option;
+	int opt;
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "subcommand ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], subcmds, "subcommand",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	switch (opt) {
+		case SDN_CONFIGURE:
+			return CmdConfigure(interp, statePtr, objc, objv);
+		break;
+
+		case SDN_HANDLER:
+			return CmdHandler(interp, statePtr, objc, objv);
+		break;
+
+		case SDN_RESULTS:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			if (statePtr->shutdown.results != NULL) {
+				Tcl_SetObjResult(interp, statePtr->shutdown.results);
+			}
+			return TCL_OK;
+		break;
+
+		case SDN_RUN:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult(interp,
+					Tcl_NewIntObj(Winpm_RunShutdownPhase(statePtr)));
+			return TCL_OK;
+		break;
+	}
+
+	return TCL_OK;
+}
@@ -0,0 +1,33 @@
+/*
+ * winpmStubInit.c --
+ *
+ *	This file contains the initializers for the winpm stub vectors.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+/*
+ * WARNING: The contents of this file is automatically generated by the
+ * tools/genStubs.tcl script. Any modifications to the function declarations
+ * below should be made in the win/winpm.decls script.
+ */
+
+/* !BEGIN!: Do not edit below this line. */
+
+WinpmStubs winpmStubs = {
+    TCL_STUB_MAGIC,
+    NULL,
+    Winpm_CreateShutdownHandler, /* 0 */
+    Winpm_DeleteShutdownHandler, /* 1 */
+    Winpm_Subscribe, /* 2 */
+    Winpm_Unsubscribe, /* 3 */
+};
+
+/* !END!: Do not edit above this line. */
@@ -0,0 +1,72 @@
+/*
+ * winpmStubLib.c --
+ *
+ *	Stub object that will be statically linked into extensions that
+ *	want to access the C interface of winpm.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#ifndef USE_TCL_STUBS
+#define USE_TCL_STUBS
+#endif
+#ifndef USE_WINPM_STUBS
+#define USE_WINPM_STUBS
+#endif
+#undef USE_WINPM_STUB_PROCS
+
+/* The stub library is linked statically into its users */
+#undef BUILD_winpm
+
+#include "winpm.h"
+
+WinpmStubs *winpmStubsPtr = NULL;
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * Winpm_InitStubs --
+ *
+ *	Checks that the correct version of winpm is loaded and that it
+ *	supports stubs. It then initialises the stub table pointers.
+ *
+ * Results:
+ *	The actual version of winpm that satisfies the request, or
+ *	NULL to indicate that an error occurred.
+ *
+ * Side effects:
+ *	Sets the stub table pointers.
+ *
+ *----------------------------------------------------------------------
+ */
+
+CONST char *
+Winpm_InitStubs (
+	Tcl_Interp *interp,
+	CONST char *version,
+	int exact
+	)
+{
+	CONST char *actualVersion;
+	ClientData clientData = NULL;
+
+	actualVersion = Tcl_PkgRequireEx(interp, "winpm", version, exact,
+			&clientData);
+	if (actualVersion == NULL) {
+		return NULL;
+	}
+
+	winpmStubsPtr = (WinpmStubs *) clientData;
+	if (winpmStubsPtr == NULL) {
+		Tcl_AppendResult(interp, "This implementation of winpm "
+				"does not support stubs", NULL);
+		return NULL;
+	}
+
+	return actualVersion;
+}
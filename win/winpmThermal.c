@@ -0,0 +1,563 @@
+/*
+ * winpmThermal.c --
+ *   Thermal zone events.
+ *
+ *   Windows doesn't notify applications of thermal conditions, so the
+ *   readings of the ACPI thermal zones are sampled from the "Thermal
+ *   Zone Information" performance counters. Sampling is driven by
+ *   a timer of the monitoring window, so the samples arrive through
+ *   the same window procedure and event queue as the power
+ *   notifications do. The counters are opened on the first sample;
+ *   pdh.dll is loaded at runtime since it may be missing.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+/* Definitions from pdh.h, not available everywhere */
+#define PDH_FMT_LONG           0x00000100
+#define PDH_MORE_DATA          ((LONG) 0x800007D2L)
+#define PDH_CSTATUS_VALID_DATA 0x00000000
+#define PDH_CSTATUS_NEW_DATA   0x00000001
+
+typedef struct {
+	LPWSTR szName;
+	struct {
+		DWORD CStatus;
+		union {
+			LONG longValue;
+			double doubleValue;
+			LONGLONG largeValue;
+			LPCSTR AnsiStringValue;
+			LPCWSTR WideStringValue;
+		} u;
+	} FmtValue;
+} PdhItem;
+
+typedef LONG (WINAPI *PdhOpenQueryProc) (LPCWSTR, DWORD_PTR, HANDLE *);
+typedef LONG (WINAPI *PdhAddCounterProc) (HANDLE, LPCWSTR, DWORD_PTR,
+		HANDLE *);
+typedef LONG (WINAPI *PdhCollectProc) (HANDLE);
+typedef LONG (WINAPI *PdhGetArrayProc) (HANDLE, DWORD, DWORD *, DWORD *,
+		PdhItem *);
+typedef LONG (WINAPI *PdhCloseQueryProc) (HANDLE);
+
+/* Serializes loading pdh.dll by the process threads */
+TCL_DECLARE_MUTEX(pdhMutex);
+
+static struct {
+	PdhOpenQueryProc openQuery;
+	PdhAddCounterProc addCounter;
+	PdhCollectProc collect;
+	PdhGetArrayProc getArray;
+	PdhCloseQueryProc closeQuery;
+} Pdh;
+
+/* Temperature is reported in kelvins */
+#define ZERO_CELSIUS 273
+
+/* Fired in this order, see Winpm_ProcessThermalSample() */
+static Winpm_EventType ThermalEvents[] = {
+	{ "THERMAL_THRESHOLD", WINPM_THERMALTHRESHOLD },
+	{ "THERMAL_TRIP",      WINPM_THERMALTRIP },
+	{ "THERMAL_THROTTLE",  WINPM_THERMALTHROTTLE },
+	{ NULL }
+};
+
+/* Last reading of a thermal zone */
+typedef struct {
+	int temperature; /* Degrees Celsius */
+	int limit; /* Passive cooling limit, percents of the full speed */
+	int above; /* Set if the temperature is at or above the threshold */
+} ThermalZone;
+
+void
+Winpm_InitThermal (
+	Winpm_InterpData *statePtr
+	)
+{
+	Winpm_RegisterEvents(ThermalEvents);
+	Tcl_InitHashTable(&statePtr->thermal.zones, TCL_STRING_KEYS);
+	statePtr->thermal.interval = 0;
+	statePtr->thermal.threshold = 0;
+	statePtr->thermal.query = NULL;
+	statePtr->thermal.failed = 0;
+}
+
+void
+Winpm_FinalizeThermal (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_HashEntry *entryPtr;
+	Tcl_HashSearch search;
+
+	if (statePtr->thermal.interval > 0) {
+		KillTimer(statePtr->hwndMonitor, WINPM_TIMER_THERMAL);
+	}
+	if (statePtr->thermal.query != NULL) {
+		Pdh.closeQuery(statePtr->thermal.query);
+		statePtr->thermal.query = NULL;
+	}
+
+	entryPtr = Tcl_FirstHashEntry(&statePtr->thermal.zones, &search);
+	while (entryPtr != NULL) {
+		ckfree((char *) Tcl_GetHashValue(entryPtr));
+		entryPtr = Tcl_NextHashEntry(&search);
+	}
+	Tcl_DeleteHashTable(&statePtr->thermal.zones);
+}
+
+/*
+ * Loads pdh.dll, if not yet loaded. The library is never unloaded
+ * since other interpreters may be using it. Returns 0 on failure.
+ */
+static int
+LoadPdh (void)
+{
+	static int loaded = 0;
+	HMODULE hmod;
+
+	if (loaded) return loaded > 0;
+
+	Tcl_MutexLock(&pdhMutex);
+	if (loaded == 0) {
+		loaded = -1;
+		hmod = LoadLibrary(_T("pdh.dll"));
+		if (hmod != NULL) {
+			Pdh.openQuery = (PdhOpenQueryProc)
+				GetProcAddress(hmod, "PdhOpenQueryW");
+			Pdh.addCounter = (PdhAddCounterProc)
+				GetProcAddress(hmod, "PdhAddEnglishCounterW");
+			Pdh.collect = (PdhCollectProc)
+				GetProcAddress(hmod, "PdhCollectQueryData");
+			Pdh.getArray = (PdhGetArrayProc)
+				GetProcAddress(hmod, "PdhGetFormattedCounterArrayW");
+			Pdh.closeQuery = (PdhCloseQueryProc)
+				GetProcAddress(hmod, "PdhCloseQuery");
+			/* PdhAddEnglishCounter() is missing before Vista */
+			if (Pdh.openQuery != NULL && Pdh.addCounter != NULL
+					&& Pdh.collect != NULL && Pdh.getArray != NULL
+					&& Pdh.closeQuery != NULL) {
+				loaded = 1;
+			}
+		}
+	}
+	Tcl_MutexUnlock(&pdhMutex);
+
+	return loaded > 0;
+}
+
+/*
+ * Opens the query for the thermal zone counters. Returns 0 if the
+ * counters are unavailable, in which case no more attempts are made.
+ */
+static int
+OpenQuery (
+	Winpm_InterpData *statePtr
+	)
+{
+	HANDLE query;
+
+	if (statePtr->thermal.query != NULL) return 1;
+	if (statePtr->thermal.failed) return 0;
+
+	if (LoadPdh() && Pdh.openQuery(NULL, 0, &query) == ERROR_SUCCESS) {
+		if (Pdh.addCounter(query,
+					L"\\Thermal Zone Information(*)\\Temperature",
+					0, &statePtr->thermal.temperature) == ERROR_SUCCESS
+				&& Pdh.addCounter(query,
+					L"\\Thermal Zone Information(*)\\% Passive Limit",
+					0, &statePtr->thermal.limit) == ERROR_SUCCESS) {
+			statePtr->thermal.query = query;
+			return 1;
+		}
+		Pdh.closeQuery(query);
+	}
+
+	statePtr->thermal.failed = 1;
+	return 0;
+}
+
+/*
+ * Returns the formatted values of all the instances of the counter
+ * in a block to be freed with ckfree(), or NULL on failure.
+ */
+static PdhItem *
+GetCounterArray (
+	HANDLE counter,
+	DWORD *countPtr
+	)
+{
+	PdhItem *items;
+	DWORD size;
+
+	size = 0;
+	*countPtr = 0;
+	if (Pdh.getArray(counter, PDH_FMT_LONG, &size, countPtr, NULL)
+			!= PDH_MORE_DATA) {
+		return NULL;
+	}
+
+	items = (PdhItem *) ckalloc(size);
+	if (Pdh.getArray(counter, PDH_FMT_LONG, &size, countPtr, items)
+			!= ERROR_SUCCESS) {
+		ckfree((char *) items);
+		return NULL;
+	}
+
+	return items;
+}
+
+static int
+IsValid (
+	CONST PdhItem *itemPtr
+	)
+{
+	return itemPtr->FmtValue.CStatus == PDH_CSTATUS_VALID_DATA
+		|| itemPtr->FmtValue.CStatus == PDH_CSTATUS_NEW_DATA;
+}
+
+/*
+ * Takes the readings of all thermal zones and reports their changes.
+ * Called when the sampling timer of the monitoring window fires.
+ */
+void
+Winpm_SampleThermal (
+	Winpm_InterpData *statePtr
+	)
+{
+	PdhItem *temps, *limits;
+	DWORD ntemps, nlimits, i, j;
+	Tcl_DString ds;
+	int limit;
+
+	if (!OpenQuery(statePtr)
+			|| Pdh.collect(statePtr->thermal.query) != ERROR_SUCCESS) {
+		return;
+	}
+
+	temps = GetCounterArray(statePtr->thermal.temperature, &ntemps);
+	if (temps == NULL) return;
+	limits = GetCounterArray(statePtr->thermal.limit, &nlimits);
+
+	for (i = 0; i < ntemps; ++i) {
+		if (!IsValid(&temps[i])) continue;
+
+		/* Instances of both counters are normally listed in the
+		 * same order, but nothing guarantees that */
+		limit = 100;
+		for (j = 0; limits != NULL && j < nlimits; ++j) {
+			if (IsValid(&limits[j])
+					&& lstrcmpW(limits[j].szName, temps[i].szName) == 0) {
+				limit = (int) limits[j].FmtValue.u.longValue;
+				break;
+			}
+		}
+
+		Tcl_DStringInit(&ds);
+		Tcl_UniCharToUtfDString((Tcl_UniChar *) temps[i].szName,
+				lstrlenW(temps[i].szName), &ds);
+		Winpm_ProcessThermalSample(statePtr, Tcl_DStringValue(&ds),
+				(int) temps[i].FmtValue.u.longValue - ZERO_CELSIUS, limit);
+		Tcl_DStringFree(&ds);
+	}
+
+	ckfree((char *) temps);
+	if (limits != NULL) {
+		ckfree((char *) limits);
+	}
+}
+
+/*
+ * Compares the new reading of the zone with the previous one
+ * and fires the events for the changes found.
+ */
+void
+Winpm_ProcessThermalSample (
+	Winpm_InterpData *statePtr,
+	CONST char *zone,
+	int temperature,
+	int limit
+	)
+{
+	Tcl_HashEntry *entryPtr;
+	ThermalZone *zonePtr, prev;
+	Winpm_Event event;
+	Winpm_PercentMap map[4];
+	char tbuf[TCL_INTEGER_SPACE], lbuf[TCL_INTEGER_SPACE];
+	int isNew, fire[3], i;
+
+	entryPtr = Tcl_CreateHashEntry(&statePtr->thermal.zones, zone, &isNew);
+	if (isNew) {
+		zonePtr = (ThermalZone *) ckalloc(sizeof(ThermalZone));
+		zonePtr->temperature = temperature;
+		zonePtr->limit = 100;
+		zonePtr->above = 0;
+		Tcl_SetHashValue(entryPtr, (ClientData) zonePtr);
+	} else {
+		zonePtr = (ThermalZone *) Tcl_GetHashValue(entryPtr);
+	}
+
+	prev = *zonePtr;
+	zonePtr->temperature = temperature;
+	zonePtr->limit = limit;
+	zonePtr->above = statePtr->thermal.threshold > 0
+		&& temperature >= statePtr->thermal.threshold;
+
+	/* The zone reaches its passive trip point when
+	 * the system starts throttling the processors */
+	fire[0] = zonePtr->above != prev.above;
+	fire[1] = prev.limit >= 100 && limit < 100;
+	fire[2] = limit != prev.limit;
+
+	memset(&event, 0, sizeof(event));
+	event.power.changed = -1;
+	event.thermal.zone = Tcl_GetHashKey(&statePtr->thermal.zones, entryPtr);
+	event.thermal.temperature = temperature;
+	event.thermal.passiveLimit = limit;
+
+	sprintf(tbuf, "%d", temperature);
+	sprintf(lbuf, "%d", limit);
+	map[0].token = 'z';
+	map[0].value = event.thermal.zone;
+	map[1].token = 't';
+	map[1].value = tbuf;
+	map[2].token = 'l';
+	map[2].value = lbuf;
+	map[3].token = '\0';
+
+	for (i = 0; i < 3; ++i) {
+		if (fire[i]) {
+			event.type = ThermalEvents[i].type;
+			Winpm_FireEvent(statePtr, &event, map, &ThermalEvents[i]);
+		}
+	}
+}
+
+/* Returns the readings in the form [winpm thermal zones] reports them */
+static Tcl_Obj *
+NewZonesObj (
+	Winpm_InterpData *statePtr
+	)
+{
+	Tcl_HashEntry *entryPtr;
+	Tcl_HashSearch search;
+	ThermalZone *zonePtr;
+	Tcl_Obj *listObj, *elems[4];
+
+	listObj = Tcl_NewListObj(0, NULL);
+	entryPtr = Tcl_FirstHashEntry(&statePtr->thermal.zones, &search);
+	while (entryPtr != NULL) {
+		zonePtr = (ThermalZone *) Tcl_GetHashValue(entryPtr);
+
+		elems[0] = Tcl_NewStringObj("temperature", -1);
+		elems[1] = Tcl_NewIntObj(zonePtr->temperature);
+		elems[2] = Tcl_NewStringObj("limit", -1);
+		elems[3] = Tcl_NewIntObj(zonePtr->limit);
+
+		Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewStringObj(
+				Tcl_GetHashKey(&statePtr->thermal.zones, entryPtr), -1));
+		Tcl_ListObjAppendElement(NULL, listObj, Tcl_NewListObj(4, elems));
+
+		entryPtr = Tcl_NextHashEntry(&search);
+	}
+
+	return listObj;
+}
+
+static const char *ConfigureOptions[] = { "-interval", "-threshold", NULL };
+typedef enum { OPT_INTERVAL, OPT_THRESHOLD } CFG_Option;
+
+/* Returns the value of the thermal option as [thermal configure] does */
+static Tcl_Obj *
+NewOptionObj (
+	Winpm_InterpData *statePtr,
+	int opt
+	)
+{
+	if (opt == OPT_INTERVAL) {
+		return Winpm_NewIntervalObj(
+				(Tcl_WideInt) statePtr->thermal.interval * 1000);
+	}
+	return Tcl_NewIntObj(statePtr->thermal.threshold);
+}
+
+/* winpm thermal configure ?-option ?value ...?? */
+static int
+CmdConfigure (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	int new[2];
+	int i, opt, value, interval;
+	Tcl_WideInt usec;
+
+	if (objc == 3) {
+		Tcl_Obj *listObj;
+
+		listObj = Tcl_NewListObj(0, NULL);
+		for (i = 0; ConfigureOptions[i] != NULL; ++i) {
+			Tcl_ListObjAppendElement(interp, listObj,
+					Tcl_NewStringObj(ConfigureOptions[i], -1));
+			Tcl_ListObjAppendElement(interp, listObj,
+					NewOptionObj(statePtr, i));
+		}
+		Tcl_SetObjResult(interp, listObj);
+		return TCL_OK;
+	}
+
+	if (objc == 4) {
+		if (Tcl_GetIndexFromObj(interp, objv[3], ConfigureOptions, "option",
+				0, &opt) != TCL_OK) { return TCL_ERROR; }
+		Tcl_SetObjResult(interp, NewOptionObj(statePtr, opt));
+		return TCL_OK;
+	}
+
+	if (objc % 2 == 0) {
+		Tcl_WrongNumArgs(interp, 3, objv, "?-option value ...?");
+		return TCL_ERROR;
+	}
+
+	/* Nothing is changed on error */
+	new[OPT_INTERVAL]  = statePtr->thermal.interval;
+	new[OPT_THRESHOLD] = statePtr->thermal.threshold;
+
+	for (i = 3; i < objc; i += 2) {
+		if (Tcl_GetIndexFromObj(interp, objv[i], ConfigureOptions, "option",
+				0, &opt) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		if (opt == OPT_INTERVAL) {
+			/* Whole milliseconds, the timer can't do better */
+			if (Winpm_GetIntervalFromObj(interp, objv[i+1],
+					&usec) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			if (usec % 1000 != 0) {
+				Tcl_AppendResult(interp, "bad value for -interval: \"",
+						Tcl_GetString(objv[i+1]), "\"", NULL);
+				return TCL_ERROR;
+			}
+			new[opt] = (int) (usec / 1000);
+			continue;
+		}
+		if (Tcl_GetIntFromObj(interp, objv[i+1], &value) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		if (value < 0) {
+			Tcl_AppendResult(interp, "bad value for ", ConfigureOptions[opt],
+					": \"", Tcl_GetString(objv[i+1]), "\"", NULL);
+			return TCL_ERROR;
+		}
+		new[opt] = value;
+	}
+
+	/* Restart sampling at the new rate; the timer needs the window */
+	interval = statePtr->thermal.interval;
+	if (new[OPT_INTERVAL] != interval) {
+		if (interval == 0 && Winpm_HoldMonitor(statePtr) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		if (interval > 0) {
+			KillTimer(statePtr->hwndMonitor, WINPM_TIMER_THERMAL);
+		}
+		if (new[OPT_INTERVAL] > 0) {
+			SetTimer(statePtr->hwndMonitor, WINPM_TIMER_THERMAL,
+					(UINT) new[OPT_INTERVAL], NULL);
+		} else {
+			Winpm_ReleaseMonitor(statePtr);
+		}
+	}
+
+	statePtr->thermal.interval  = new[OPT_INTERVAL];
+	statePtr->thermal.threshold = new[OPT_THRESHOLD];
+	return TCL_OK;
+}
+
+/* winpm thermal subcommand ?arg ...? */
+int
+Winpm_CmdThermal (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	static const char *subcmds[] = { "configure", "sample", "zones", NULL };
+	typedef enum { THM_CONFIGURE, THM_SAMPLE, THM_ZONES } THM_Option;
+	int opt;
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "subcommand ?arg ...?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj(interp, objv[2], subcmds, "subcommand",
+			0, &opt) != TCL_OK) { return TCL_ERROR; }
+
+	switch (opt) {
+		case THM_CONFIGURE:
+			return CmdConfigure(interp, statePtr, objc, objv);
+		break;
+
+		case THM_SAMPLE:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			Winpm_SampleThermal(statePtr);
+			return TCL_OK;
+		break;
+
+		case THM_ZONES:
+			if (objc != 3) {
+				Tcl_WrongNumArgs(interp, 3, objv, NULL);
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult(interp, NewZonesObj(statePtr));
+			return TCL_OK;
+		break;
+	}
+
+	return TCL_OK;
+}
+
+/*
+ * winpm _thermal zone temperature limit
+ *
+ * Processes the reading as if it was sampled from the counters.
+ */
+int
+Winpm_CmdThermalSample (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	int temperature, limit;
+
+	if (objc != 5) {
+		Tcl_WrongNumArgs(interp, 2, objv, "zone temperature limit");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIntFromObj(interp, objv[3], &temperature) != TCL_OK
+			|| Tcl_GetIntFromObj(interp, objv[4], &limit) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	Winpm_ProcessThermalSample(statePtr, Tcl_GetString(objv[2]),
+			temperature, limit);
+	return TCL_OK;
+}
@@ -0,0 +1,464 @@
+/*
+ * winpmThread.c --
+ *   Delivering events to interpreters of other threads.
+ *
+ *   The monitoring window belongs to the thread of the interpreter
+ *   which created it, and so do the scripts bound to its events.
+ *   Interpreters of other threads (Thread package workers) register
+ *   as listeners in a process-wide list instead, and an interpreter
+ *   watching the events delivers them to each listener interested:
+ *   the decoded event is copied once into a reference-counted block
+ *   which is queued to the threads of the listeners with Tcl events,
+ *   and each thread makes its Tcl objects from that block itself.
+ *
+ * Copyright (c) 2007 Konstantin Khomoutov.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ * $Id$
+ */
+
+#include "winpmInt.h"
+
+#define ZONE_NAME 64 /* Space for the name of a thermal zone */
+
+typedef struct Listener {
+	Winpm_InterpData *statePtr; /* Of the listening interpreter */
+	Tcl_ThreadId thread; /* Of that interpreter */
+	int mask; /* WINPM_* event types listened to */
+	char *command; /* Command prefix; objects can't cross threads */
+	struct Listener *nextPtr;
+} Listener;
+
+/* Process-wide list of listeners protected by listenMutex */
+TCL_DECLARE_MUTEX(listenMutex);
+static Listener *listeners = NULL;
+
+/* Event shared by all the threads it's delivered to */
+typedef struct {
+	volatile LONG refCount;
+	Winpm_Event event;
+	char zone[ZONE_NAME];
+} SharedEvent;
+
+typedef struct {
+	Tcl_Event header;
+	Winpm_InterpData *statePtr; /* Of the listener */
+	SharedEvent *sharedPtr;
+} DeliveredEvent;
+
+/*
+ * Parses the list of the names of events into the mask of their
+ * WINPM_* bits. Events subscribers don't get can't be listened to.
+ */
+static int
+GetEventMaskFromObj (
+	Tcl_Interp *interp,
+	Tcl_Obj *objPtr,
+	int *maskPtr
+	)
+{
+	Winpm_EventType *typePtr;
+	Tcl_Obj **elems;
+	int i, n, mask;
+
+	if (Tcl_ListObjGetElements(interp, objPtr, &n, &elems) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	mask = 0;
+	for (i = 0; i < n; ++i) {
+		if (Winpm_GetEventTypeFromObj(interp, elems[i],
+				&typePtr) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		if (typePtr->type == 0) {
+			Tcl_AppendResult(interp, "can't listen to ",
+					typePtr->name, NULL);
+			return TCL_ERROR;
+		}
+		mask |= typePtr->type;
+	}
+
+	*maskPtr = mask;
+	return TCL_OK;
+}
+
+static Tcl_Obj *
+NewEventMaskObj (
+	int mask
+	)
+{
+	Winpm_EventType *typePtr;
+	Tcl_Obj *listObj;
+	int id;
+
+	listObj = Tcl_NewListObj(0, NULL);
+	for (id = 0; id < Winpm_CountEvents(); ++id) {
+		typePtr = Winpm_GetEventType(id);
+		if (mask & typePtr->type) {
+			Tcl_ListObjAppendElement(NULL, listObj,
+					Tcl_NewStringObj(typePtr->name, -1));
+		}
+	}
+	return listObj;
+}
+
+/* Returns the fields of the event as a dictionary */
+static Tcl_Obj *
+NewEventDictObj (
+	CONST Winpm_Event *eventPtr
+	)
+{
+	Tcl_Obj *dictObj = Tcl_NewDictObj();
+
+#define PUT(key, valueObj) \
+	Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj(key, -1), valueObj)
+
+	switch (eventPtr->type) {
+		case WINPM_QUERYENDSESSION:
+		case WINPM_ENDSESSION:
+			PUT("final", Tcl_NewBooleanObj(eventPtr->session.final));
+			PUT("flags", Tcl_NewLongObj((long) eventPtr->session.flags));
+		break;
+
+		case WINPM_POWERSTATUSCHANGE:
+			if (eventPtr->power.changed == -1) break;
+			PUT("ac", Tcl_NewStringObj(Winpm_ACLineStatusName(
+					(BYTE) eventPtr->power.acLine), -1));
+			PUT("battery", Tcl_NewStringObj(Winpm_BatteryFlagName(
+					(BYTE) eventPtr->power.batteryFlag), -1));
+			PUT("percent", Tcl_NewIntObj(eventPtr->power.batteryPercent));
+			PUT("lifetime", Tcl_NewLongObj(eventPtr->power.batteryLifeTime));
+			PUT("changed", Winpm_NewPowerFieldsObj(eventPtr->power.changed));
+		break;
+
+		case WINPM_OEMEVENT:
+			PUT("code", Tcl_NewLongObj(eventPtr->oemCode));
+		break;
+
+		case WINPM_PROFILECHANGE:
+			PUT("profile", Tcl_NewStringObj(
+					Winpm_ProfileName(eventPtr->profile.personality), -1));
+			PUT("saver", Tcl_NewIntObj(eventPtr->profile.saver));
+		break;
+
+		case WINPM_THERMALTHRESHOLD:
+		case WINPM_THERMALTRIP:
+		case WINPM_THERMALTHROTTLE:
+			PUT("zone", Tcl_NewStringObj(eventPtr->thermal.zone, -1));
+			PUT("temperature", Tcl_NewIntObj(eventPtr->thermal.temperature));
+			PUT("limit", Tcl_NewIntObj(eventPtr->thermal.passiveLimit));
+		break;
+
+		case WINPM_MEMORYPRESSURE:
+			PUT("load", Tcl_NewIntObj(eventPtr->memory.load));
+			PUT("available", Tcl_NewLongObj(eventPtr->memory.available));
+		break;
+
+		case WINPM_USERIDLE:
+		case WINPM_USERACTIVE:
+			PUT("time", Tcl_NewLongObj(eventPtr->idle.time));
+		break;
+
+		case WINPM_POWERSOURCE:
+			PUT("source", Tcl_NewStringObj(
+					Winpm_PowerSourceName(eventPtr->source), -1));
+		break;
+
+		case WINPM_TIMECHANGE:
+			PUT("step", Tcl_NewLongObj(eventPtr->step));
+		break;
+
+		case WINPM_SESSIONLOCK:
+		case WINPM_SESSIONUNLOCK:
+		case WINPM_SESSIONSWITCH:
+			PUT("session", Tcl_NewWideIntObj((Tcl_WideInt) eventPtr->wts.id));
+			if (eventPtr->type == WINPM_SESSIONSWITCH) {
+				PUT("reason", Tcl_NewStringObj(
+						Winpm_SessionReasonName(eventPtr->wts.reason), -1));
+			}
+		break;
+	}
+
+#undef PUT
+
+	return dictObj;
+}
+
+static void
+ReleaseShared (
+	SharedEvent *sharedPtr
+	)
+{
+	if (InterlockedDecrement(&sharedPtr->refCount) == 0) {
+		ckfree((char *) sharedPtr);
+	}
+}
+
+/* Runs the command of the listener on its thread */
+static int
+ProcessDelivered (
+	Tcl_Event *evPtr,
+	int flags
+	)
+{
+	DeliveredEvent *deliveredPtr = (DeliveredEvent *) evPtr;
+	SharedEvent *sharedPtr = deliveredPtr->sharedPtr;
+	Tcl_Interp *interp = deliveredPtr->statePtr->interp;
+	Listener *listPtr;
+	Tcl_Obj *cmdObj;
+	int code;
+
+	if (!(flags & TCL_WINDOW_EVENTS)) return 0;
+
+	/* The listener may have changed its mind since then */
+	cmdObj = NULL;
+	Tcl_MutexLock(&listenMutex);
+	for (listPtr = listeners; listPtr; listPtr = listPtr->nextPtr) {
+		if (listPtr->statePtr == deliveredPtr->statePtr) {
+			if (listPtr->mask & sharedPtr->event.type) {
+				cmdObj = Tcl_NewStringObj(listPtr->command, -1);
+			}
+			break;
+		}
+	}
+	Tcl_MutexUnlock(&listenMutex);
+
+	if (cmdObj != NULL) {
+		Tcl_IncrRefCount(cmdObj);
+		sharedPtr->event.thermal.zone = sharedPtr->zone;
+		if (Tcl_ListObjAppendElement(interp, cmdObj, Tcl_NewStringObj(
+					Winpm_FindEventType(sharedPtr->event.type)->name, -1)) == TCL_OK
+				&& Tcl_ListObjAppendElement(interp, cmdObj,
+					NewEventDictObj(&sharedPtr->event)) == TCL_OK) {
+			Tcl_Preserve((ClientData) interp);
+			code = Tcl_EvalObjEx(interp, cmdObj, TCL_EVAL_GLOBAL);
+			if (code == TCL_ERROR) {
+				Tcl_AddErrorInfo(interp, "\n    (" PACKAGE_NAME
+						" listener)");
+				Tcl_BackgroundError(interp);
+			}
+			Tcl_Release((ClientData) interp);
+		} else {
+			Tcl_BackgroundError(interp);
+		}
+		Tcl_DecrRefCount(cmdObj);
+	}
+
+	ReleaseShared(sharedPtr);
+	return 1;
+}
+
+/* Matches the events queued for the interpreter, dropping them */
+static int
+IsDeliveredEvent (
+	Tcl_Event *evPtr,
+	ClientData clientData
+	)
+{
+	DeliveredEvent *deliveredPtr = (DeliveredEvent *) evPtr;
+
+	if (evPtr->proc != ProcessDelivered
+			|| deliveredPtr->statePtr != (Winpm_InterpData *) clientData) {
+		return 0;
+	}
+	ReleaseShared(deliveredPtr->sharedPtr);
+	return 1;
+}
+
+/* Subscriber of the delivering interpreter */
+static int
+Deliver (
+	ClientData clientData,
+	CONST Winpm_Event *eventPtr
+	)
+{
+	SharedEvent *sharedPtr = NULL;
+	DeliveredEvent *deliveredPtr;
+	Listener *listPtr;
+
+	Tcl_MutexLock(&listenMutex);
+	for (listPtr = listeners; listPtr; listPtr = listPtr->nextPtr) {
+		if (!(listPtr->mask & eventPtr->type)) continue;
+
+		if (sharedPtr == NULL) {
+			sharedPtr = (SharedEvent *) ckalloc(sizeof(SharedEvent));
+			sharedPtr->refCount = 0;
+			sharedPtr->event = *eventPtr;
+			sharedPtr->zone[0] = '\0';
+			if (eventPtr->thermal.zone != NULL) {
+				strncpy(sharedPtr->zone, eventPtr->thermal.zone,
+						ZONE_NAME - 1);
+				sharedPtr->zone[ZONE_NAME - 1] = '\0';
+			}
+			sharedPtr->event.thermal.zone = NULL;
+		}
+		InterlockedIncrement(&sharedPtr->refCount);
+
+		deliveredPtr = (DeliveredEvent *) ckalloc(sizeof(DeliveredEvent));
+		deliveredPtr->header.proc = ProcessDelivered;
+		deliveredPtr->statePtr = listPtr->statePtr;
+		deliveredPtr->sharedPtr = sharedPtr;
+		Tcl_ThreadQueueEvent(listPtr->thread, (Tcl_Event *) deliveredPtr,
+				TCL_QUEUE_TAIL);
+		Tcl_ThreadAlert(listPtr->thread);
+	}
+	Tcl_MutexUnlock(&listenMutex);
+
+	return TCL_OK;
+}
+
+/* Removes the listener of the interpreter, if any */
+static void
+StopListening (
+	Winpm_InterpData *statePtr
+	)
+{
+	Listener **linkPtr, *listPtr;
+
+	Tcl_MutexLock(&listenMutex);
+	for (linkPtr = &listeners; *linkPtr; linkPtr = &(*linkPtr)->nextPtr) {
+		if ((*linkPtr)->statePtr == statePtr) {
+			listPtr = *linkPtr;
+			*linkPtr = listPtr->nextPtr;
+			ckfree(listPtr->command);
+			ckfree((char *) listPtr);
+			break;
+		}
+	}
+	Tcl_MutexUnlock(&listenMutex);
+}
+
+void
+Winpm_InitListen (
+	Winpm_InterpData *statePtr
+	)
+{
+	statePtr->listen.delivering = 0;
+}
+
+void
+Winpm_FinalizeListen (
+	Winpm_InterpData *statePtr
+	)
+{
+	if (statePtr->listen.delivering) {
+		Winpm_Unsubscribe(statePtr->interp, WINPM_ALL_EVENTS,
+				Deliver, NULL);
+	}
+	StopListening(statePtr);
+	Tcl_DeleteEvents(IsDeliveredEvent, (ClientData) statePtr);
+	Winpm_InitListen(statePtr);
+}
+
+/*
+ * winpm listen
+ * winpm listen events command
+ *
+ * Without arguments returns the events listened to and the command,
+ * if any; an empty command stops listening.
+ */
+int
+Winpm_CmdListen (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	Listener *listPtr;
+	CONST char *command;
+	int mask, len;
+
+	if (objc == 2) {
+		Tcl_MutexLock(&listenMutex);
+		for (listPtr = listeners; listPtr; listPtr = listPtr->nextPtr) {
+			if (listPtr->statePtr == statePtr) {
+				Tcl_Obj *elems[2];
+
+				elems[0] = NewEventMaskObj(listPtr->mask);
+				elems[1] = Tcl_NewStringObj(listPtr->command, -1);
+				Tcl_SetObjResult(interp, Tcl_NewListObj(2, elems));
+				break;
+			}
+		}
+		Tcl_MutexUnlock(&listenMutex);
+		return TCL_OK;
+	}
+
+	if (objc != 4) {
+		Tcl_WrongNumArgs(interp, 2, objv, "?events command?");
+		return TCL_ERROR;
+	}
+
+	if (GetEventMaskFromObj(interp, objv[2], &mask) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	StopListening(statePtr);
+
+	command = Tcl_GetStringFromObj(objv[3], &len);
+	if (len == 0 || mask == 0) {
+		return TCL_OK;
+	}
+
+	listPtr = (Listener *) ckalloc(sizeof(Listener));
+	listPtr->statePtr = statePtr;
+	listPtr->thread = Tcl_GetCurrentThread();
+	listPtr->mask = mask;
+	listPtr->command = ckalloc(len + 1);
+	memcpy(listPtr->command, command, len + 1);
+
+	Tcl_MutexLock(&listenMutex);
+	listPtr->nextPtr = listeners;
+	listeners = listPtr;
+	Tcl_MutexUnlock(&listenMutex);
+
+	return TCL_OK;
+}
+
+/*
+ * winpm deliver ?boolean?
+ *
+ * Starts or stops delivering the events of this interpreter to the
+ * listeners; without arguments tells whether it's delivering them.
+ */
+int
+Winpm_CmdDeliver (
+	Tcl_Interp *interp,
+	Winpm_InterpData *statePtr,
+	int objc,
+	Tcl_Obj *const objv[]
+	)
+{
+	int deliver;
+
+	if (objc == 2) {
+		Tcl_SetObjResult(interp,
+				Tcl_NewBooleanObj(statePtr->listen.delivering));
+		return TCL_OK;
+	}
+
+	if (objc != 3) {
+		Tcl_WrongNumArgs(interp, 2, objv, "?boolean?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetBooleanFromObj(interp, objv[2], &deliver) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	if (deliver && !statePtr->listen.delivering) {
+		if (Winpm_Subscribe(interp, WINPM_ALL_EVENTS,
+				Deliver, NULL) != TCL_OK) {
+			return TCL_ERROR;
+		}
+	} else if (!deliver && statePtr->listen.delivering) {
+		Winpm_Unsubscribe(interp, WINPM_ALL_EVENTS, Deliver, NULL);
+	}
+
+	statePtr->listen.delivering = deliver;
+	return TCL_OK;
+}